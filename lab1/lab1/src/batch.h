@@ -0,0 +1,198 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <chrono>
+
+#include "defines.h"
+#include "operation.h"
+#include "variable.h"
+#include "function.h"
+
+// Output buffer of every batch file, the functions are written to it and flushed in big blocks.
+constexpr u64 BATCH_BUFFER_SIZE = 1 << 20;
+
+// The spec is the interactive input repeated for every function, without the limits on the
+// counts: variable count, type and value of every variable, operation count and
+// (1st operand) operation (2nd operand) of every operation, all separated by whitespace.
+struct BatchOptions {
+    std::string spec_path;
+    std::string out_path;
+    // Functions per output file, 0 puts all of them in out_path. Otherwise the files are
+    // out_path with _0, _1, ... before the extension.
+    u64 shard_size{ 0 };
+    // Folds the operations on the constants at generation time, see write_f_function.
+    bool fold_constants{ false };
+};
+
+struct BatchReport {
+    u64 functions{ 0 };
+    u64 files{ 0 };
+    u64 bytes{ 0 };
+    // Operations left as runtime expressions with fold_constants.
+    u64 not_folded{ 0 };
+    f64 seconds{ 0.0 };
+};
+
+// Writes the functions f1, f2, ... of the spec. Stops at the first invalid function.
+bool write_batch(const BatchOptions& options, BatchReport& report);
+
+// A spec of `functions` random functions with 2-6 variables and 1-20 operations.
+bool write_random_spec(const std::string& path, u64 functions, u64 seed = 5489);
+
+//
+
+std::string get_shard_path(const std::string& path, u64 shard) {
+    const u64 slash = path.find_last_of("/\\");
+    const u64 dot = path.find_last_of('.');
+    const u64 split = (dot == std::string::npos || (slash != std::string::npos && dot < slash)) ? path.size() : dot;
+    return path.substr(0, split) + "_" + std::to_string(shard) + path.substr(split);
+}
+
+bool read_function(std::istream& in, const u64 index, std::vector<Variable>& variables, std::vector<Operation>& operations) {
+    u64 var_count = 0;
+    if (!(in >> var_count) || var_count == 0) {
+        std::cout << "Error: function " << index << ": invalid variable count.\n";
+        return false;
+    }
+
+    variables.assign(var_count, Variable{});
+    for (auto& var : variables) {
+        u32 type{ 0 };
+        in >> type;
+        if (type <= static_cast<u32>(VariableType::UNKNOWN) || static_cast<u32>(VariableType::COUNT) <= type) {
+            std::cout << "Error: function " << index << ": invalid type for variable.\n";
+            return false;
+        }
+        var.type = static_cast<VariableType>(type);
+        read_var_value(in, var);
+    }
+
+    u64 ops_count = 0;
+    if (!(in >> ops_count)) {
+        std::cout << "Error: function " << index << ": invalid operations count.\n";
+        return false;
+    }
+
+    operations.assign(ops_count, Operation{});
+    for (auto& op : operations) {
+        u32 type{ 0 };
+        in >> op.operands[0] >> type >> op.operands[1];
+        if (op.operands[0] < 1 || var_count < op.operands[0] || op.operands[1] < 1 || var_count < op.operands[1]) {
+            std::cout << "Error: function " << index << ": invalid operand.\n";
+            return false;
+        }
+        if (type <= static_cast<u32>(OperationType::UNKNOWN) || static_cast<u32>(OperationType::COUNT) <= type) {
+            std::cout << "Error: function " << index << ": invalid operation.\n";
+            return false;
+        }
+        op.type = static_cast<OperationType>(type);
+    }
+
+    return !in.fail();
+}
+
+bool write_batch(const BatchOptions& options, BatchReport& report) {
+    using clock_t = std::chrono::steady_clock;
+    const auto start = clock_t::now();
+
+    std::ifstream in;
+    std::unique_ptr<char[]> in_buffer(new char[BATCH_BUFFER_SIZE]);
+    in.rdbuf()->pubsetbuf(in_buffer.get(), BATCH_BUFFER_SIZE);
+    in.open(options.spec_path);
+    if (!in.is_open()) {
+        std::cout << "Error: Failed to open the spec file.\n";
+        return false;
+    }
+
+    // One stream for all shards, the buffer has to be set before the first open.
+    std::ofstream out;
+    std::unique_ptr<char[]> out_buffer(new char[BATCH_BUFFER_SIZE]);
+    out.rdbuf()->pubsetbuf(out_buffer.get(), BATCH_BUFFER_SIZE);
+
+    auto close_file = [&]() {
+        if (out.is_open()) {
+            report.bytes += static_cast<u64>(out.tellp());
+            out.close();
+        }
+    };
+
+    // The vectors keep their capacity from one function to the next.
+    std::vector<Variable> variables;
+    std::vector<Operation> operations;
+    report = {};
+
+    while (in >> std::ws, !in.eof()) {
+        const u64 index = report.functions + 1;
+        if (!read_function(in, index, variables, operations)) {
+            close_file();
+            return false;
+        }
+
+        if (!out.is_open() || (options.shard_size > 0 && report.functions % options.shard_size == 0)) {
+            close_file();
+            const std::string path = options.shard_size > 0 ? get_shard_path(options.out_path, report.files) : options.out_path;
+            out.open(path);
+            if (!out.is_open()) {
+                std::cout << "Error: Failed to open the file.\n";
+                return false;
+            }
+            out << "#include <iostream>\n";
+            ++report.files;
+        }
+
+        out << "\n";
+        report.not_folded += write_f_function(out, "f" + std::to_string(index), variables.data(), static_cast<u32>(variables.size()),
+            operations.data(), static_cast<u32>(operations.size()), options.fold_constants);
+        ++report.functions;
+    }
+    close_file();
+
+    report.seconds = std::chrono::duration<f64>(clock_t::now() - start).count();
+    return true;
+}
+
+bool write_random_spec(const std::string& path, u64 functions, u64 seed) {
+    std::ofstream out{ path };
+    if (!out.is_open()) {
+        std::cout << "Error: Failed to open the file.\n";
+        return false;
+    }
+
+    std::mt19937 mt(static_cast<u32>(seed));
+    for (u64 f = 0; f < functions; ++f) {
+        const u32 var_count = mt() % 5 + 2;
+        bool floating[6]{ false };
+        out << var_count << "\n";
+        for (u32 i = 0; i < var_count; ++i) {
+            const u32 type = mt() % (static_cast<u32>(VariableType::COUNT) - 1) + 1;
+            floating[i] = type == static_cast<u32>(VariableType::F32) || type == static_cast<u32>(VariableType::F64);
+            out << type << " ";
+            switch (static_cast<VariableType>(type)) {
+            case VariableType::I8:
+            case VariableType::U8:  { out << mt() % 128; } break;
+            case VariableType::F32:
+            case VariableType::F64: { out << mt() % 1000 << ".5"; } break;
+            default: { out << mt() % 1000; } break;
+            };
+            out << "\n";
+        }
+
+        const u32 ops_count = mt() % 20 + 1;
+        out << ops_count << "\n";
+        for (u32 i = 0; i < ops_count; ++i) {
+            const u32 lhs = mt() % var_count;
+            const u32 rhs = mt() % var_count;
+            u32 type = mt() % (static_cast<u32>(OperationType::COUNT) - 1) + 1;
+            // '%' does not compile for floating point operands.
+            if (type == static_cast<u32>(OperationType::REM) && (floating[lhs] || floating[rhs])) {
+                type = static_cast<u32>(OperationType::MUL);
+            }
+            out << lhs + 1 << " " << type << " " << rhs + 1 << "\n";
+        }
+    }
+    return true;
+}
\ No newline at end of file
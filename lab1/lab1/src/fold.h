@@ -0,0 +1,209 @@
+#pragma once
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <cmath>
+#include <type_traits>
+
+#include "defines.h"
+#include "operation.h"
+#include "variable.h"
+
+// An operation evaluated at generation time. When `folded` is false the operation has to stay
+// a runtime expression and `reason` says why.
+struct FoldResult {
+    bool folded{ false };
+    std::string type_name;
+    std::string literal;
+    std::string reason;
+};
+
+// Evaluates `lhs op rhs` with the C++ types of the variables, so the usual arithmetic
+// conversions and the unsigned wraparound are the compiler's own. Division or modulo by zero,
+// signed overflow and '%' on floating point operands are not folded.
+FoldResult fold_operation(const Variable& lhs, const OperationType type, const Variable& rhs);
+
+//
+
+// Calls f with the value of the variable as its own type.
+template<typename F>
+void visit_var_value(const Variable& var, F f) {
+    switch (var.type) {
+    case VariableType::I8:  { f(var.value.i8); } break;
+    case VariableType::U8:  { f(var.value.u8); } break;
+    case VariableType::I16: { f(var.value.i16); } break;
+    case VariableType::U16: { f(var.value.u16); } break;
+    case VariableType::I32: { f(var.value.i32); } break;
+    case VariableType::U32: { f(var.value.u32); } break;
+    case VariableType::I64: { f(var.value.i64); } break;
+    case VariableType::U64: { f(var.value.u64); } break;
+    case VariableType::F32: { f(var.value.f32); } break;
+    case VariableType::F64: { f(var.value.f64); } break;
+    default: {
+        UNREACHABLE();
+    } break;
+    };
+}
+
+// Name of an arithmetic result type, after the promotions only these are left.
+template<typename T>
+std::string get_result_type_name() {
+    if constexpr (std::is_same_v<T, int>) return "int";
+    else if constexpr (std::is_same_v<T, unsigned int>) return "unsigned int";
+    else if constexpr (std::is_same_v<T, long>) return "long";
+    else if constexpr (std::is_same_v<T, unsigned long>) return "unsigned long";
+    else if constexpr (std::is_same_v<T, long long>) return "long long";
+    else if constexpr (std::is_same_v<T, unsigned long long>) return "unsigned long long";
+    else if constexpr (std::is_same_v<T, float>) return "float";
+    else if constexpr (std::is_same_v<T, double>) return "double";
+    else static_assert(!sizeof(T), "Unexpected result type.");
+}
+
+// A literal with the exact value, of type T from int up.
+template<typename T>
+std::string get_literal(const T value) {
+    std::ostringstream out;
+    if constexpr (std::is_floating_point_v<T>) {
+        out << std::setprecision(std::numeric_limits<T>::max_digits10) << value;
+        std::string res = out.str();
+        if (res.find_first_of(".e") == std::string::npos) {
+            res += ".0";
+        }
+        return std::is_same_v<T, float> ? res + "f" : res;
+    }
+    else if constexpr (std::is_signed_v<T>) {
+        // The minimum has no literal, the negation of a too large literal is not one.
+        if (value == std::numeric_limits<T>::min()) {
+            out << "(" << value + 1 << " - 1)";
+        }
+        else {
+            out << +value;
+        }
+    }
+    else {
+        // The unary plus prints char types as numbers.
+        out << +value << "u";
+    }
+    return out.str();
+}
+
+template<typename T>
+bool add_overflows(const T x, const T y) {
+    if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        return (y > 0 && x > std::numeric_limits<T>::max() - y) || (y < 0 && x < std::numeric_limits<T>::min() - y);
+    }
+    return false;
+}
+
+template<typename T>
+bool sub_overflows(const T x, const T y) {
+    if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        return (y < 0 && x > std::numeric_limits<T>::max() + y) || (y > 0 && x < std::numeric_limits<T>::min() + y);
+    }
+    return false;
+}
+
+template<typename T>
+bool mul_overflows(const T x, const T y) {
+    if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        constexpr T max = std::numeric_limits<T>::max();
+        constexpr T min = std::numeric_limits<T>::min();
+        if (x > 0) {
+            return y > 0 ? x > max / y : y < min / x;
+        }
+        return y > 0 ? x < min / y : (x != 0 && y < max / x);
+    }
+    return false;
+}
+
+template<typename A, typename B>
+FoldResult fold_values(const A a, const OperationType type, const B b) {
+    // The common type of the usual arithmetic conversions, the same for all five operations.
+    using C = decltype(a + b);
+    const C x = static_cast<C>(a);
+    const C y = static_cast<C>(b);
+
+    FoldResult res;
+    C value{ 0 };
+    switch (type) {
+    case OperationType::SUM: {
+        if (add_overflows(x, y)) {
+            res.reason = "signed overflow";
+            return res;
+        }
+        value = x + y;
+    } break;
+    case OperationType::SUB: {
+        if (sub_overflows(x, y)) {
+            res.reason = "signed overflow";
+            return res;
+        }
+        value = x - y;
+    } break;
+    case OperationType::MUL: {
+        if (mul_overflows(x, y)) {
+            res.reason = "signed overflow";
+            return res;
+        }
+        value = x * y;
+    } break;
+    case OperationType::DIV: {
+        if (y == 0) {
+            res.reason = "division by zero";
+            return res;
+        }
+        if constexpr (std::is_integral_v<C> && std::is_signed_v<C>) {
+            if (x == std::numeric_limits<C>::min() && y == -1) {
+                res.reason = "signed overflow";
+                return res;
+            }
+        }
+        value = x / y;
+    } break;
+    case OperationType::REM: {
+        if constexpr (std::is_floating_point_v<C>) {
+            res.reason = "'%' on floating point operands";
+            return res;
+        }
+        else {
+            if (y == 0) {
+                res.reason = "modulo by zero";
+                return res;
+            }
+            if constexpr (std::is_signed_v<C>) {
+                if (x == std::numeric_limits<C>::min() && y == -1) {
+                    res.reason = "signed overflow";
+                    return res;
+                }
+            }
+            value = x % y;
+        }
+    } break;
+    default: {
+        UNREACHABLE();
+    } break;
+    };
+
+    if constexpr (std::is_floating_point_v<C>) {
+        if (!std::isfinite(value)) {
+            res.reason = "result is not finite";
+            return res;
+        }
+    }
+
+    res.folded = true;
+    res.type_name = get_result_type_name<C>();
+    res.literal = get_literal(value);
+    return res;
+}
+
+FoldResult fold_operation(const Variable& lhs, const OperationType type, const Variable& rhs) {
+    FoldResult res;
+    visit_var_value(lhs, [&](const auto a) {
+        visit_var_value(rhs, [&](const auto b) {
+            res = fold_values(a, type, b);
+        });
+    });
+    return res;
+}
\ No newline at end of file
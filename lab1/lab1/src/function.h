@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <iostream>
+
+#include "defines.h"
+#include "operation.h"
+#include "variable.h"
+#include "fold.h"
+
+// Writes `void name() { ... }`: the variables var1, var2, ... with their values and one line of
+// output for every operation. Operands are 1 based indices of the variables.
+// With `fold_constants` the variables are constexpr and every operation that folds becomes a
+// constexpr result1, result2, ... of the exact result type, the rest stay runtime expressions
+// with a comment. Returns the number of operations that were not folded.
+u32 write_f_function(std::ostream& out, const std::string& name, const Variable* variables, const u32 var_count, const Operation* operations, const u32 ops_count, const bool fold_constants = false) {
+    out << "void " << name << "() {\n";
+
+    for (u32 i = 0; i < var_count; ++i) {
+        const auto& var = variables[i];
+        out << "    " << (fold_constants ? "constexpr " : "") << get_var_type_name(var.type) << " var" << i + 1 << "{ ";
+        if (fold_constants) {
+            // Every digit, so the declared value is the one the results were folded from.
+            visit_var_value(var, [&out](const auto value) { out << get_literal(value); });
+        }
+        else {
+            write_var_value(out, var);
+        }
+        out << " };\n";
+    }
+    out << "\n";
+
+    u32 not_folded = 0;
+    for (u32 i = 0; i < ops_count; ++i) {
+        const auto& op = operations[i];
+        // Without asserts an operand out of range is never folded, the generated code does not compile then.
+        const bool in_range = 1 <= op.operands[0] && op.operands[0] <= var_count && 1 <= op.operands[1] && op.operands[1] <= var_count;
+        assert(in_range && "Operand out of range.");
+
+        std::string result = "var" + std::to_string(op.operands[0]) + " " + get_op_type_value(op.type) + " var" + std::to_string(op.operands[1]);
+        if (fold_constants) {
+            const FoldResult fold = in_range
+                ? fold_operation(variables[op.operands[0] - 1], op.type, variables[op.operands[1] - 1])
+                : FoldResult{ false, "", "", "operand out of range" };
+            if (fold.folded) {
+                result = "result" + std::to_string(i + 1);
+                out << "    constexpr " << fold.type_name << " " << result << "{ " << fold.literal << " };\n";
+            }
+            else {
+                out << "    // not folded: " << fold.reason << "\n";
+                ++not_folded;
+            }
+        }
+
+        out << "    std::cout << \"var" << op.operands[0] << "(\" << var" << op.operands[0] << " << \") " << get_op_type_value(op.type) << " var" << op.operands[1] << "(\" << var" << op.operands[1] << " << \") = \" << " << result << " << \"\\n\";\n";
+    }
+
+    out << "}\n";
+    return not_folded;
+}
\ No newline at end of file
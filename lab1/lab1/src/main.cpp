@@ -4,10 +4,12 @@
 
 #include "operation.h"
 #include "variable.h"
+#include "function.h"
+#include "batch.h"
 
 constexpr const char* ORDIONAL_NOUNS[] = { "first", "second", "third", "fourth", "fifth", "sixth", "seventh", "eighth", "ninth", "tenth" };
 
-bool write_file_with_f_function(const std::string& filepath, Variable* variables, const u32 var_count, Operation* operations, const u32 ops_count) {
+bool write_file_with_f_function(const std::string& filepath, Variable* variables, const u32 var_count, Operation* operations, const u32 ops_count, const bool fold_constants = false) {
     std::ofstream out{ filepath };
     if (!out.is_open()) {
         std::cout << "Error: Failed to open the file.\n";
@@ -16,44 +18,46 @@ bool write_file_with_f_function(const std::string& filepath, Variable* variables
 
     out << ""
         "#include <iostream>\n"
-        "\n"
-        "void f() {\n";
-
-    for (u32 i = 0; i < var_count; ++i) {
-        const auto& var = variables[i];
-        out << "    " << get_var_type_name(var.type) << " var" << i + 1 << "{ ";
-
-        switch (var.type) {
-        case VariableType::I8:  { out << var.value.i8; } break;
-        case VariableType::U8:  { out << var.value.u8; } break;
-        case VariableType::I16: { out << var.value.i16; } break;
-        case VariableType::U16: { out << var.value.u16; } break;
-        case VariableType::I32: { out << var.value.i32; } break;
-        case VariableType::U32: { out << var.value.u32; } break;
-        case VariableType::I64: { out << var.value.i64; } break;
-        case VariableType::U64: { out << var.value.u64; } break;
-        case VariableType::F32: { out << var.value.f32; } break;
-        case VariableType::F64: { out << var.value.f64; } break;
-        default: {
-            UNREACHABLE();
-        } break;
-        };
-        out << " };\n";
-    }
-    out << "\n";
-
-    for (u32 i = 0; i < ops_count; ++i) {
-        const auto& op = operations[i];
-
-        out << "    std::cout << \"var" << op.operands[0] << "(\" << var" << op.operands[0] << " << \") " << get_op_type_value(op.type) << " var" << op.operands[1] << "(\" << var" << op.operands[1] << " << \") = \" << var" << op.operands[0] << " " << get_op_type_value(op.type) << " var" << op.operands[1] << " << \"\\n\";\n";
-    }
-
-    out << "}" << std::endl;
+        "\n";
+    write_f_function(out, "f", variables, var_count, operations, ops_count, fold_constants);
+    out.flush();
 
     return true;
 }
 
 int main(int argc, char** argv) {
+    // lab1 --batch <spec> <output> [functions per file] [--fold]: every function of the spec file, no prompts.
+    if (argc > 3 && std::string(argv[1]) == "--batch") {
+        BatchOptions options;
+        options.spec_path = argv[2];
+        options.out_path = argv[3];
+        for (int i = 4; i < argc; ++i) {
+            if (std::string(argv[i]) == "--fold") {
+                options.fold_constants = true;
+            }
+            else {
+                options.shard_size = std::stoull(argv[i]);
+            }
+        }
+
+        BatchReport report;
+        if (!write_batch(options, report)) {
+            return 1;
+        }
+        std::cout << report.functions << " functions, " << report.files << " files, " << report.bytes << " bytes in "
+            << report.seconds * 1e3 << " ms: " << static_cast<f64>(report.functions) / report.seconds << " functions/s\n";
+        if (options.fold_constants) {
+            std::cout << report.not_folded << " operations not folded\n";
+        }
+        return 0;
+    }
+    // lab1 --spec <path> <count>: a spec of random functions for --batch.
+    if (argc > 3 && std::string(argv[1]) == "--spec") {
+        return write_random_spec(argv[2], std::stoull(argv[3])) ? 0 : 1;
+    }
+    // lab1 --fold: the interactive mode with the operations folded at generation time.
+    const bool fold_constants = argc > 1 && std::string(argv[1]) == "--fold";
+
     u32 var_count = 0;
     std::cout << "Enter variable count [2 or 3]:\n";
 
@@ -83,18 +87,7 @@ int main(int argc, char** argv) {
 
         vars[var_num].type = static_cast<VariableType>(input);
 
-        switch (vars[var_num].type) {
-        case VariableType::I8: { std::cin >> vars[var_num].value.i8; } break;
-        case VariableType::U8: { std::cin >> vars[var_num].value.u8; } break;
-        case VariableType::I16: { std::cin >> vars[var_num].value.i16; } break;
-        case VariableType::U16: { std::cin >> vars[var_num].value.u16; } break;
-        case VariableType::I32: { std::cin >> vars[var_num].value.i32; } break;
-        case VariableType::U32: { std::cin >> vars[var_num].value.u32; } break;
-        case VariableType::I64: { std::cin >> vars[var_num].value.i64; } break;
-        case VariableType::U64: { std::cin >> vars[var_num].value.u64; } break;
-        case VariableType::F32: { std::cin >> vars[var_num].value.f32; } break;
-        case VariableType::F64: { std::cin >> vars[var_num].value.f64; } break;
-        };
+        read_var_value(std::cin, vars[var_num]);
 
         ++var_num;
     }
@@ -111,7 +104,7 @@ int main(int argc, char** argv) {
         u32 input{ 0 };
 
         std::cin >> input;
-        if (input < 1 && var_count < input) {
+        if (input < 1 || var_count < input) {
             std::cout << "Error: ivalid 1st operand. Try again..\n";
             continue;
         }
@@ -135,7 +128,7 @@ int main(int argc, char** argv) {
         op_num++;
     }
 
-    write_file_with_f_function("D:/study/univer/ITMO/cplusplus/lab1/lab1_test/src/f.cpp", vars, var_count, operations, ops_count);
+    write_file_with_f_function("D:/study/univer/ITMO/cplusplus/lab1/lab1_test/src/f.cpp", vars, var_count, operations, ops_count, fold_constants);
 
     return 0;
 }
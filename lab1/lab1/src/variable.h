@@ -55,6 +55,44 @@ std::string get_var_type_name(const VariableType  type) {
     };
 }
 
+// i8 and u8 are read and written as numbers, not as characters.
+void read_var_value(std::istream& in, Variable& var) {
+    i32 small{ 0 };
+    switch (var.type) {
+    case VariableType::I8:  { in >> small; var.value.i8 = static_cast<i8>(small); } break;
+    case VariableType::U8:  { in >> small; var.value.u8 = static_cast<u8>(small); } break;
+    case VariableType::I16: { in >> var.value.i16; } break;
+    case VariableType::U16: { in >> var.value.u16; } break;
+    case VariableType::I32: { in >> var.value.i32; } break;
+    case VariableType::U32: { in >> var.value.u32; } break;
+    case VariableType::I64: { in >> var.value.i64; } break;
+    case VariableType::U64: { in >> var.value.u64; } break;
+    case VariableType::F32: { in >> var.value.f32; } break;
+    case VariableType::F64: { in >> var.value.f64; } break;
+    default: {
+        UNREACHABLE();
+    } break;
+    };
+}
+
+void write_var_value(std::ostream& out, const Variable& var) {
+    switch (var.type) {
+    case VariableType::I8:  { out << static_cast<i32>(var.value.i8); } break;
+    case VariableType::U8:  { out << static_cast<i32>(var.value.u8); } break;
+    case VariableType::I16: { out << var.value.i16; } break;
+    case VariableType::U16: { out << var.value.u16; } break;
+    case VariableType::I32: { out << var.value.i32; } break;
+    case VariableType::U32: { out << var.value.u32; } break;
+    case VariableType::I64: { out << var.value.i64; } break;
+    case VariableType::U64: { out << var.value.u64; } break;
+    case VariableType::F32: { out << var.value.f32; } break;
+    case VariableType::F64: { out << var.value.f64; } break;
+    default: {
+        UNREACHABLE();
+    } break;
+    };
+}
+
 void print_var_types() {
     std::cout << "Available variables types:\n";
     for (u32 i = static_cast<u32>(VariableType::UNKNOWN) + 1; i != static_cast<u32>(VariableType::COUNT); ++i) {
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+#include "defines.h"
+
+constexpr u64 STRING_POOL_SHARDS = 64;
+
+// Decimal text of every value interned so far, one copy per distinct value. The pool is split
+// into shards by value, each with its own lock, so threads interning different values rarely
+// wait for each other. The strings never move, references stay valid until clear().
+class StringPool {
+public:
+    StringPool() = default;
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+public:
+    // Thread safe.
+    const std::string& intern(i64 value);
+    u64 get_size() const;
+    // Not thread safe, every reference into the pool dangles afterwards.
+    void clear();
+private:
+    // A cache line each, so the locks of neighbouring shards do not share one.
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<i64, std::string> strings;
+    };
+
+    Shard& get_shard(i64 value);
+private:
+    std::array<Shard, STRING_POOL_SHARDS> _shards;
+};
+
+// The pool of the InternedNumbers that are not given one.
+StringPool& get_string_pool();
+
+// The flyweight Number: the value and a pointer to its text in a StringPool. Copies are two
+// words, equal values share one string.
+class InternedNumber {
+public:
+    explicit InternedNumber(i64 value) : InternedNumber(value, get_string_pool()) {}
+    InternedNumber(i64 value, StringPool& pool) : _value{ value }, _str{ &pool.intern(value) } {}
+public:
+    bool operator==(const InternedNumber& other) const { return _value == other._value; }
+public:
+    i64 get_i64() const { return _value; }
+    const std::string& get_str() const { return *_str; }
+private:
+    i64 _value{ 0 };
+    const std::string* _str{ nullptr };
+};
+
+// Fills a vector of `size` values drawn from `distinct` values on `threads` threads and copies
+// it, once with a private std::string per element like Number and once interned.
+void bench_intern(u64 size, u64 distinct, u64 threads = 0);
+
+//
+
+StringPool::Shard& StringPool::get_shard(i64 value) {
+    // Fibonacci hashing, consecutive values land in different shards.
+    const u64 hash = static_cast<u64>(value) * 0x9E3779B97F4A7C15ull;
+    return _shards[hash >> 58];
+}
+
+const std::string& StringPool::intern(i64 value) {
+    static_assert(STRING_POOL_SHARDS == 64, "get_shard() takes the top 6 bits of the hash.");
+
+    Shard& shard = get_shard(value);
+    {
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.strings.find(value);
+        if (it != shard.strings.end()) {
+            return it->second;
+        }
+    }
+
+    // Another thread may have added the value between the locks, emplace keeps the first.
+    std::unique_lock lock(shard.mutex);
+    return shard.strings.try_emplace(value, std::to_string(value)).first->second;
+}
+
+u64 StringPool::get_size() const {
+    u64 size = 0;
+    for (const Shard& shard : _shards) {
+        std::shared_lock lock(shard.mutex);
+        size += shard.strings.size();
+    }
+    return size;
+}
+
+void StringPool::clear() {
+    for (Shard& shard : _shards) {
+        std::unique_lock lock(shard.mutex);
+        shard.strings.clear();
+    }
+}
+
+StringPool& get_string_pool() {
+    static StringPool pool;
+    return pool;
+}
+
+void bench_intern(u64 size, u64 distinct, u64 threads) {
+    using clock_t = std::chrono::steady_clock;
+
+    if (threads == 0) {
+        threads = std::max<u64>(1, std::thread::hardware_concurrency());
+    }
+    distinct = std::max<u64>(1, distinct);
+
+    // Every thread fills its own slice from its own generator.
+    auto fill = [&](auto make) {
+        std::vector<decltype(make(i64{}))> v(size, make(0));
+        std::vector<std::thread> workers;
+        for (u64 t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                std::mt19937_64 mt(t);
+                for (u64 i = size * t / threads; i < size * (t + 1) / threads; ++i) {
+                    v[i] = make(static_cast<i64>(mt() % distinct) * 1'000'003);
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        return v;
+    };
+    auto seconds = [](clock_t::time_point start) {
+        return std::chrono::duration<f64>(clock_t::now() - start).count();
+    };
+
+    std::cout << size << " values, " << distinct << " distinct, " << threads << " threads\n";
+
+    // Number without the logging: the value and a private copy of its text.
+    using OwnedNumber = std::pair<i64, std::string>;
+    auto start = clock_t::now();
+    std::vector<OwnedNumber> owned = fill([](i64 value) { return OwnedNumber(value, std::to_string(value)); });
+    std::cout << "    owned, fill: " << seconds(start) * 1e3 << " ms\n";
+    start = clock_t::now();
+    std::vector<OwnedNumber> owned_copy = owned;
+    std::cout << "    owned, copy: " << seconds(start) * 1e3 << " ms, " << sizeof(OwnedNumber)
+        << " bytes per element and the text past the small string buffer\n";
+
+    StringPool pool;
+    start = clock_t::now();
+    std::vector<InternedNumber> interned = fill([&pool](i64 value) { return InternedNumber(value, pool); });
+    std::cout << "    interned, fill: " << seconds(start) * 1e3 << " ms\n";
+    start = clock_t::now();
+    std::vector<InternedNumber> interned_copy = interned;
+    std::cout << "    interned, copy: " << seconds(start) * 1e3 << " ms, " << sizeof(InternedNumber)
+        << " bytes per element and " << pool.get_size() << " pooled strings\n";
+
+    bool same = true;
+    for (u64 i = 0; same && i < size; ++i) {
+        same = owned_copy[i].first == interned_copy[i].get_i64() && owned_copy[i].second == interned_copy[i].get_str();
+    }
+    std::cout << "    same result: " << same << "\n";
+}
\ No newline at end of file
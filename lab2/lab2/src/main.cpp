@@ -1,8 +1,10 @@
 #include <iostream>
 #include <vector>
 #include <list>
+#include <string>
 
 #include "number.h"
+#include "intern.h"
 
 void print(const Number& number) {
     std::cout << "[" << number.get_i64() << ":\"" << number.get_str() << "\"]\n";
@@ -23,7 +25,19 @@ void print(const T& numbers) {
     std::cout << std::endl;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // lab2 --words [size]: the number to words formatters instead of the lab run.
+    if (argc > 1 && std::string(argv[1]) == "--words") {
+        bench_words(argc > 2 ? std::stoull(argv[2]) : 1'000'000);
+        return 0;
+    }
+    // lab2 --intern [size] [distinct] [threads]: private strings against the interning pool.
+    if (argc > 1 && std::string(argv[1]) == "--intern") {
+        bench_intern(argc > 2 ? std::stoull(argv[2]) : 10'000'000, argc > 3 ? std::stoull(argv[3]) : 1000,
+            argc > 4 ? std::stoull(argv[4]) : 0);
+        return 0;
+    }
+
     Number num1(10);
     print(num1);
 
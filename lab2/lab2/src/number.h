@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include "defines.h"
+#include "words.h"
 
 class Number {
 public:
@@ -39,6 +40,8 @@ public:
 public:
     i64 get_i64() const { return _value; }
     std::string get_str() const { return _str; }
+    // The value spelled out, e.g. 22 and "двадцать два".
+    std::string get_words(Language language = Language::RUSSIAN) const { return to_words(_value, language); }
 private:
     i64 _value{ 0 };
     std::string _str;
@@ -0,0 +1,374 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <array>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+#include "defines.h"
+
+enum class Language : u32 {
+    ENGLISH = 0,
+    RUSSIAN = 1,
+};
+
+// Enough for the longest i64 in either language, the Russian text is UTF-8.
+constexpr u64 WORDS_BUFFER_SIZE = 512;
+// Groups of three digits in a u64, up to the quintillions.
+constexpr u64 WORDS_SCALES = 7;
+
+// Writes `value` in words to [first, last) and returns the end of the text like std::to_chars,
+// or nullptr when it does not fit. Nothing is allocated.
+char* to_words(char* first, char* last, i64 value, Language language);
+
+std::string to_words(i64 value, Language language);
+
+// Writes the values one after another to [first, last), value i ends at first + offsets[i + 1]
+// and offsets[0] is 0, so `offsets` holds count + 1 entries. Stops before the first value that
+// does not fit and returns how many values were written.
+u64 to_words(const i64* values, u64 count, char* first, char* last, u64* offsets, Language language);
+
+// Recursive string concatenation, the reference for the benchmark.
+std::string naive_words(i64 value, Language language);
+
+// Compares the naive version, the single value and the batch formatter on random values of
+// every magnitude.
+void bench_words(u64 size);
+
+//
+
+constexpr std::array<std::string_view, 20> ENGLISH_UNITS = {
+    "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine",
+    "ten", "eleven", "twelve", "thirteen", "fourteen", "fifteen", "sixteen", "seventeen", "eighteen", "nineteen",
+};
+constexpr std::array<std::string_view, 10> ENGLISH_TENS = {
+    "", "", "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety",
+};
+constexpr std::array<std::string_view, WORDS_SCALES> ENGLISH_SCALES = {
+    "", "thousand", "million", "billion", "trillion", "quadrillion", "quintillion",
+};
+
+constexpr std::array<std::string_view, 20> RUSSIAN_UNITS = {
+    "ноль", "один", "два", "три", "четыре", "пять", "шесть", "семь", "восемь", "девять",
+    "десять", "одиннадцать", "двенадцать", "тринадцать", "четырнадцать", "пятнадцать", "шестнадцать", "семнадцать", "восемнадцать", "девятнадцать",
+};
+// Thousands are feminine: одна тысяча, две тысячи.
+constexpr std::array<std::string_view, 3> RUSSIAN_FEMININE_UNITS = { "", "одна", "две" };
+constexpr std::array<std::string_view, 10> RUSSIAN_TENS = {
+    "", "", "двадцать", "тридцать", "сорок", "пятьдесят", "шестьдесят", "семьдесят", "восемьдесят", "девяносто",
+};
+constexpr std::array<std::string_view, 10> RUSSIAN_HUNDREDS = {
+    "", "сто", "двести", "триста", "четыреста", "пятьсот", "шестьсот", "семьсот", "восемьсот", "девятьсот",
+};
+// Nominative singular after 1, genitive singular after 2-4, genitive plural after the rest.
+constexpr std::array<std::array<std::string_view, 3>, WORDS_SCALES> RUSSIAN_SCALES = { {
+    { "", "", "" },
+    { "тысяча", "тысячи", "тысяч" },
+    { "миллион", "миллиона", "миллионов" },
+    { "миллиард", "миллиарда", "миллиардов" },
+    { "триллион", "триллиона", "триллионов" },
+    { "квадриллион", "квадриллиона", "квадриллионов" },
+    { "квинтиллион", "квинтиллиона", "квинтиллионов" },
+} };
+
+// Index into RUSSIAN_SCALES for a group of three digits.
+constexpr u64 russian_form(u64 n) {
+    const u64 tens = n % 100;
+    const u64 units = n % 10;
+    if (tens >= 11 && tens <= 14) {
+        return 2;
+    }
+    return units == 1 ? 0 : (units >= 2 && units <= 4 ? 1 : 2);
+}
+
+// Words for 1..999 (0 is empty). With out == nullptr only the length is counted.
+constexpr u64 render_triad(char* out, u64 n, Language language, bool feminine) {
+    u64 pos = 0;
+    auto append = [&](std::string_view s) {
+        for (char c : s) {
+            if (out) {
+                out[pos] = c;
+            }
+            ++pos;
+        }
+    };
+    auto word = [&](std::string_view s) {
+        if (pos > 0) {
+            append(" ");
+        }
+        append(s);
+    };
+
+    const u64 hundreds = n / 100;
+    const u64 rest = n % 100;
+    if (language == Language::ENGLISH) {
+        if (hundreds > 0) {
+            word(ENGLISH_UNITS[hundreds]);
+            word("hundred");
+        }
+        if (rest >= 20) {
+            word(ENGLISH_TENS[rest / 10]);
+            if (rest % 10 > 0) {
+                append("-");
+                append(ENGLISH_UNITS[rest % 10]);
+            }
+        }
+        else if (rest > 0) {
+            word(ENGLISH_UNITS[rest]);
+        }
+    }
+    else {
+        if (hundreds > 0) {
+            word(RUSSIAN_HUNDREDS[hundreds]);
+        }
+        if (rest >= 20) {
+            word(RUSSIAN_TENS[rest / 10]);
+        }
+        const u64 units = rest >= 20 ? rest % 10 : rest;
+        if (units > 0) {
+            word(feminine && units <= 2 ? RUSSIAN_FEMININE_UNITS[units] : RUSSIAN_UNITS[units]);
+        }
+    }
+    return pos;
+}
+
+constexpr u64 triad_table_size(Language language, bool feminine) {
+    u64 size = 0;
+    for (u64 n = 0; n < 1000; ++n) {
+        size += render_triad(nullptr, n, language, feminine);
+    }
+    return size;
+}
+
+constexpr u64 TRIAD_TABLE_SIZE = std::max({
+    triad_table_size(Language::ENGLISH, false),
+    triad_table_size(Language::RUSSIAN, false),
+    triad_table_size(Language::RUSSIAN, true),
+});
+
+// The words of all 1000 groups of three digits packed one after another.
+struct TriadTable {
+    std::array<char, TRIAD_TABLE_SIZE> chars{};
+    std::array<u32, 1001> offsets{};
+
+    TriadTable(Language language, bool feminine) {
+        for (u64 n = 0; n < 1000; ++n) {
+            offsets[n + 1] = offsets[n] + static_cast<u32>(render_triad(chars.data() + offsets[n], n, language, feminine));
+        }
+    }
+
+    std::string_view get(u64 n) const { return { chars.data() + offsets[n], offsets[n + 1] - offsets[n] }; }
+};
+
+// English, Russian masculine and Russian feminine, built on first use.
+const TriadTable& get_triad_table(Language language, bool feminine) {
+    static const std::array<TriadTable, 3> tables = {
+        TriadTable(Language::ENGLISH, false),
+        TriadTable(Language::RUSSIAN, false),
+        TriadTable(Language::RUSSIAN, true),
+    };
+    return tables[language == Language::ENGLISH ? 0 : (feminine ? 2 : 1)];
+}
+
+char* put_words(char* out, std::string_view s) {
+    std::memcpy(out, s.data(), s.size());
+    return out + s.size();
+}
+
+// Unchecked, `out` must have WORDS_BUFFER_SIZE bytes of room.
+char* write_words(char* out, i64 value, Language language) {
+    const bool english = language == Language::ENGLISH;
+    if (value == 0) {
+        return put_words(out, english ? ENGLISH_UNITS[0] : RUSSIAN_UNITS[0]);
+    }
+
+    // The magnitude in u64, so the minimum i64 does not overflow.
+    u64 magnitude = value < 0 ? 0 - static_cast<u64>(value) : static_cast<u64>(value);
+    if (value < 0) {
+        out = put_words(out, english ? "minus " : "минус ");
+    }
+
+    std::array<u64, WORDS_SCALES> triads{};
+    u64 count = 0;
+    while (magnitude > 0) {
+        triads[count++] = magnitude % 1000;
+        magnitude /= 1000;
+    }
+
+    bool first = true;
+    for (u64 s = count; s-- > 0;) {
+        const u64 triad = triads[s];
+        if (triad == 0) {
+            continue;
+        }
+        if (!first) {
+            *out++ = ' ';
+        }
+        first = false;
+
+        out = put_words(out, get_triad_table(language, !english && s == 1).get(triad));
+        if (s > 0) {
+            *out++ = ' ';
+            out = put_words(out, english ? ENGLISH_SCALES[s] : RUSSIAN_SCALES[s][russian_form(triad)]);
+        }
+    }
+    return out;
+}
+
+char* to_words(char* first, char* last, i64 value, Language language) {
+    if (static_cast<u64>(last - first) >= WORDS_BUFFER_SIZE) {
+        return write_words(first, value, language);
+    }
+
+    char buffer[WORDS_BUFFER_SIZE];
+    const u64 size = static_cast<u64>(write_words(buffer, value, language) - buffer);
+    if (size > static_cast<u64>(last - first)) {
+        return nullptr;
+    }
+    std::memcpy(first, buffer, size);
+    return first + size;
+}
+
+std::string to_words(i64 value, Language language) {
+    char buffer[WORDS_BUFFER_SIZE];
+    return std::string(buffer, write_words(buffer, value, language));
+}
+
+u64 to_words(const i64* values, u64 count, char* first, char* last, u64* offsets, Language language) {
+    char* out = first;
+    offsets[0] = 0;
+    u64 i = 0;
+    // While a whole worst case value fits, no value needs a check.
+    for (; i < count && static_cast<u64>(last - out) >= WORDS_BUFFER_SIZE; ++i) {
+        out = write_words(out, values[i], language);
+        offsets[i + 1] = static_cast<u64>(out - first);
+    }
+    for (; i < count; ++i) {
+        char* end = to_words(out, last, values[i], language);
+        if (!end) {
+            break;
+        }
+        out = end;
+        offsets[i + 1] = static_cast<u64>(out - first);
+    }
+    return i;
+}
+
+std::string naive_words(u64 n, u64 scale, Language language) {
+    if (n >= 1000) {
+        std::string high = naive_words(n / 1000, scale + 1, language);
+        std::string low = naive_words(n % 1000, scale, language);
+        return low.empty() ? high : high + " " + low;
+    }
+    if (n == 0) {
+        return "";
+    }
+
+    const bool english = language == Language::ENGLISH;
+    std::string res;
+    auto word = [&res](std::string_view s) {
+        if (!res.empty()) {
+            res += " ";
+        }
+        res += std::string(s);
+    };
+
+    if (n >= 100) {
+        if (english) {
+            word(ENGLISH_UNITS[n / 100]);
+            word("hundred");
+        }
+        else {
+            word(RUSSIAN_HUNDREDS[n / 100]);
+        }
+    }
+    const u64 rest = n % 100;
+    if (english) {
+        if (rest >= 20) {
+            word(ENGLISH_TENS[rest / 10]);
+            if (rest % 10 > 0) {
+                res += "-" + std::string(ENGLISH_UNITS[rest % 10]);
+            }
+        }
+        else if (rest > 0) {
+            word(ENGLISH_UNITS[rest]);
+        }
+    }
+    else {
+        if (rest >= 20) {
+            word(RUSSIAN_TENS[rest / 10]);
+        }
+        const u64 units = rest >= 20 ? rest % 10 : rest;
+        if (units > 0) {
+            word(scale == 1 && units <= 2 ? RUSSIAN_FEMININE_UNITS[units] : RUSSIAN_UNITS[units]);
+        }
+    }
+    if (scale > 0) {
+        word(english ? ENGLISH_SCALES[scale] : RUSSIAN_SCALES[scale][russian_form(n)]);
+    }
+    return res;
+}
+
+std::string naive_words(i64 value, Language language) {
+    const bool english = language == Language::ENGLISH;
+    if (value == 0) {
+        return std::string(english ? ENGLISH_UNITS[0] : RUSSIAN_UNITS[0]);
+    }
+    const u64 magnitude = value < 0 ? 0 - static_cast<u64>(value) : static_cast<u64>(value);
+    std::string res = naive_words(magnitude, 0, language);
+    return value < 0 ? (english ? "minus " : "минус ") + res : res;
+}
+
+void bench_words(u64 size) {
+    using clock_t = std::chrono::steady_clock;
+
+    // Random bits shifted by a random amount, so short and long numbers are equally common.
+    std::mt19937_64 mt;
+    std::vector<i64> values(size);
+    for (i64& value : values) {
+        value = static_cast<i64>(mt() >> (mt() % 64));
+    }
+
+    std::vector<u64> offsets(size + 1);
+
+    for (Language language : { Language::ENGLISH, Language::RUSSIAN }) {
+        std::cout << (language == Language::ENGLISH ? "english" : "russian") << ", " << size << " values\n";
+
+        auto start = clock_t::now();
+        std::vector<std::string> reference;
+        reference.reserve(size);
+        for (i64 value : values) {
+            reference.push_back(naive_words(value, language));
+        }
+        f64 time = std::chrono::duration<f64>(clock_t::now() - start).count();
+        std::cout << "    naive: " << static_cast<f64>(size) / time / 1e6 << " M values/s\n";
+
+        char buffer[WORDS_BUFFER_SIZE];
+        u64 bytes = 0;
+        start = clock_t::now();
+        for (i64 value : values) {
+            bytes += static_cast<u64>(to_words(buffer, buffer + WORDS_BUFFER_SIZE, value, language) - buffer);
+        }
+        time = std::chrono::duration<f64>(clock_t::now() - start).count();
+        std::cout << "    single: " << static_cast<f64>(size) / time / 1e6 << " M values/s, " << bytes << " bytes\n";
+
+        // The arena is sized and touched before the clock starts, the batch only writes.
+        std::vector<char> arena(bytes + WORDS_BUFFER_SIZE);
+        start = clock_t::now();
+        const u64 written = to_words(values.data(), size, arena.data(), arena.data() + arena.size(), offsets.data(), language);
+        const u64 used = offsets[written];
+        time = std::chrono::duration<f64>(clock_t::now() - start).count();
+        std::cout << "    batch: " << static_cast<f64>(size) / time / 1e6 << " M values/s, " << used << " bytes\n";
+
+        bool same = written == size && used == bytes;
+        for (u64 i = 0; same && i < size; ++i) {
+            same = std::string_view(arena.data() + offsets[i], offsets[i + 1] - offsets[i]) == reference[i];
+        }
+        std::cout << "    same result: " << same << "\n";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <algorithm>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "defines.h"
+
+// Replaces every global operator new and delete of the program, the nothrow and aligned ones
+// too, with malloc and free that count every allocation. Include it in exactly one translation
+// unit.
+struct AllocationStats {
+    u64 count{ 0 };
+    u64 bytes{ 0 };
+
+    AllocationStats operator-(const AllocationStats& other) const {
+        return { count - other.count, bytes - other.bytes };
+    }
+};
+
+// Allocations made by all threads since the start of the program.
+AllocationStats get_allocation_stats();
+
+//
+
+std::atomic<u64> allocation_count{ 0 };
+std::atomic<u64> allocation_bytes{ 0 };
+
+AllocationStats get_allocation_stats() {
+    return { allocation_count.load(std::memory_order_relaxed), allocation_bytes.load(std::memory_order_relaxed) };
+}
+
+void* counted_malloc(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* counted_aligned_malloc(std::size_t size, std::align_val_t align) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    const std::size_t alignment = static_cast<std::size_t>(align);
+#ifdef _WIN32
+    void* p = _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+    // aligned_alloc needs the size to be a nonzero multiple of the alignment.
+    void* p = std::aligned_alloc(alignment, std::max<std::size_t>(1, (size + alignment - 1) / alignment) * alignment);
+#endif
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void aligned_free(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(std::size_t size) {
+    return counted_malloc(size);
+}
+
+void* operator new[](std::size_t size) {
+    return counted_malloc(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return counted_malloc(size);
+    }
+    catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return counted_malloc(size);
+    }
+    catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    return counted_aligned_malloc(size, align);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return counted_aligned_malloc(size, align);
+}
+
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try {
+        return counted_aligned_malloc(size, align);
+    }
+    catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try {
+        return counted_aligned_malloc(size, align);
+    }
+    catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    aligned_free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    aligned_free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    aligned_free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    aligned_free(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    aligned_free(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    aligned_free(p);
+}
\ No newline at end of file
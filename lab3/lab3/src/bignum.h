@@ -0,0 +1,680 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <array>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <compare>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cassert>
+
+#include "defines.h"
+
+// Magnitudes up to this many 64 bit limbs live inside the BigNumber.
+constexpr u64 BIGNUM_INLINE_LIMBS = 2;
+// Below this many limbs in the shorter factor the schoolbook product is faster.
+constexpr u64 KARATSUBA_THRESHOLD = 32;
+// Below this many limbs decimal text is made by repeated division by 10^9.
+constexpr u64 BIGNUM_DECIMAL_THRESHOLD = 32;
+// Digits of 10^18, the smallest of the cached powers 10^(18 * 2^j).
+constexpr u64 BIGNUM_POWER_DIGITS = 18;
+
+struct DecimalPower;
+
+// Arbitrary precision counterpart of Number: sign and magnitude in base 2^64 limbs, least
+// significant first, with the decimal text cached on the first get_str() call.
+class BigNumber {
+public:
+    explicit BigNumber(i64 value);
+    // Optional '-' followed by decimal digits.
+    explicit BigNumber(std::string_view text);
+    BigNumber(const BigNumber& other);
+    BigNumber(BigNumber&& other) noexcept;
+    ~BigNumber() = default;
+public:
+    BigNumber& operator=(const BigNumber& other);
+    BigNumber& operator=(BigNumber&& other) noexcept;
+    bool operator==(const BigNumber& other) const;
+    std::strong_ordering operator<=>(const BigNumber& other) const;
+
+    BigNumber operator-() const;
+    BigNumber operator+(const BigNumber& other) const;
+    BigNumber operator-(const BigNumber& other) const;
+    BigNumber operator*(const BigNumber& other) const;
+    BigNumber& operator+=(const BigNumber& other) { return *this = *this + other; }
+    BigNumber& operator-=(const BigNumber& other) { return *this = *this - other; }
+    BigNumber& operator*=(const BigNumber& other) { return *this = *this * other; }
+    // Shifts of the magnitude, the sign is kept.
+    BigNumber operator<<(u64 bits) const;
+    BigNumber operator>>(u64 bits) const;
+public:
+    bool is_zero() const { return _size == 0; }
+    bool is_negative() const { return _negative; }
+    bool fits_i64() const;
+    i64 get_i64() const;
+    u64 get_limbs() const { return _size; }
+    u64 get_bits() const;
+    // Divide and conquer through the cached powers of ten, O(M(n) log n) instead of O(n^2).
+    // Like Number::get_str() the first call writes the cache and must not race with another.
+    std::string_view get_str() const;
+private:
+    BigNumber() = default;
+
+    const u64* limbs() const { return _heap ? _heap.get() : _inline.data(); }
+    u64* limbs() { return _heap ? _heap.get() : _inline.data(); }
+    // New limbs are zero.
+    void resize(u64 size);
+    // Drops the leading zero limbs, zero is never negative.
+    void trim();
+
+    static i32 compare_magnitudes(const BigNumber& a, const BigNumber& b);
+    static BigNumber add_magnitudes(const BigNumber& a, const BigNumber& b);
+    // |a| - |b|, |a| >= |b|.
+    static BigNumber sub_magnitudes(const BigNumber& a, const BigNumber& b);
+
+    // In place |x| = |x| / divisor, returns the remainder.
+    u32 divide_small(u32 divisor);
+    // In place |x| = |x| * factor + addend.
+    void multiply_add_small(u32 factor, u32 addend);
+
+    static void write_digits(const BigNumber& x, u64 level, u64 pad, std::string& out);
+    static BigNumber parse_digits(std::string_view digits);
+private:
+    u64 _size{ 0 };
+    u64 _capacity{ BIGNUM_INLINE_LIMBS };
+    bool _negative{ false };
+    std::array<u64, BIGNUM_INLINE_LIMBS> _inline{};
+    std::unique_ptr<u64[]> _heap;
+    mutable std::string _str;
+
+    friend struct DecimalPower;
+    friend BigNumber reciprocal(const BigNumber& d);
+    friend void divide_by_power(const BigNumber& x, const DecimalPower& p, BigNumber& q, BigNumber& r);
+    friend void bench_bignum(u64 digits);
+};
+
+// 10^(18 * 2^level) with its Barrett reciprocal floor(2^(2 * bits) / power).
+struct DecimalPower {
+    BigNumber power;
+    BigNumber inverse;
+    u64 bits;
+    u64 digits;
+};
+
+// Built on first use and kept, the references stay valid.
+const DecimalPower& get_decimal_power(u64 level);
+
+// Times the schoolbook and Karatsuba products and the quadratic and divide and conquer decimal
+// conversions of a number with about `digits` digits.
+void bench_bignum(u64 digits);
+
+//
+
+// Low half of a * b, the high half goes to `high`.
+u64 mul_wide(u64 a, u64 b, u64& high) {
+    const u64 a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+    const u64 b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+    const u64 lo_lo = a_lo * b_lo;
+    const u64 hi_lo = a_hi * b_lo;
+    const u64 lo_hi = a_lo * b_hi;
+    const u64 cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    high = a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+    return (cross << 32) | (lo_lo & 0xFFFFFFFF);
+}
+
+// out[0, n) += b[0, nb) with nb <= n, returns the carry out of the top limb.
+u64 limbs_add(u64* out, u64 n, const u64* b, u64 nb) {
+    u64 carry = 0;
+    for (u64 i = 0; i < nb; ++i) {
+        const u64 s = out[i] + carry;
+        carry = s < carry;
+        out[i] = s + b[i];
+        carry += out[i] < s;
+    }
+    for (u64 i = nb; carry && i < n; ++i) {
+        carry = ++out[i] == 0;
+    }
+    return carry;
+}
+
+// out[0, n) -= b[0, nb) with nb <= n, returns the borrow out of the top limb.
+u64 limbs_sub(u64* out, u64 n, const u64* b, u64 nb) {
+    u64 borrow = 0;
+    for (u64 i = 0; i < nb; ++i) {
+        const u64 x = out[i];
+        const u64 y = b[i] + borrow;
+        borrow = (y < borrow) | (x < y);
+        out[i] = x - y;
+    }
+    for (u64 i = nb; borrow && i < n; ++i) {
+        borrow = out[i]-- == 0;
+    }
+    return borrow;
+}
+
+// out[0, na + nb) = a * b, `out` must be zero.
+void limbs_mul_basecase(u64* out, const u64* a, u64 na, const u64* b, u64 nb) {
+    for (u64 i = 0; i < nb; ++i) {
+        u64 carry = 0;
+        for (u64 j = 0; j < na; ++j) {
+            u64 high;
+            u64 low = mul_wide(a[j], b[i], high);
+            low += carry;
+            high += low < carry;
+            out[i + j] += low;
+            high += out[i + j] < low;
+            carry = high;
+        }
+        out[i + na] = carry;
+    }
+}
+
+// out[0, na + nb) = a * b, `out` must be zero.
+void limbs_mul(u64* out, const u64* a, u64 na, const u64* b, u64 nb) {
+    if (na < nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (nb < KARATSUBA_THRESHOLD) {
+        limbs_mul_basecase(out, a, na, b, nb);
+        return;
+    }
+
+    const u64 h = (na + 1) / 2;
+    if (nb <= h) {
+        // Unbalanced: a in pieces of nb limbs, every piece product added at its place.
+        std::vector<u64> part(2 * nb);
+        for (u64 lo = 0; lo < na; lo += nb) {
+            const u64 len = std::min(nb, na - lo);
+            std::fill(part.begin(), part.end(), 0);
+            limbs_mul(part.data(), a + lo, len, b, nb);
+            limbs_add(out + lo, na + nb - lo, part.data(), len + nb);
+        }
+        return;
+    }
+
+    // a = a1 B^h + a0, b = b1 B^h + b0 and a b = z2 B^2h + (z1 - z2 - z0) B^h + z0 with
+    // z0 = a0 b0, z2 = a1 b1 and z1 = (a0 + a1)(b0 + b1).
+    const u64 na1 = na - h;
+    const u64 nb1 = nb - h;
+    std::vector<u64> sa(a, a + h);
+    std::vector<u64> sb(b, b + h);
+    sa.push_back(limbs_add(sa.data(), h, a + h, na1));
+    sb.push_back(limbs_add(sb.data(), h, b + h, nb1));
+
+    std::vector<u64> z1(2 * h + 2, 0);
+    limbs_mul(z1.data(), sa.data(), h + 1, sb.data(), h + 1);
+    limbs_mul(out, a, h, b, h);
+    limbs_mul(out + 2 * h, a + h, na1, b + h, nb1);
+    limbs_sub(z1.data(), z1.size(), out, 2 * h);
+    limbs_sub(z1.data(), z1.size(), out + 2 * h, na1 + nb1);
+
+    u64 len = z1.size();
+    while (len > 0 && z1[len - 1] == 0) {
+        --len;
+    }
+    assert((len <= na + nb - h) && "Karatsuba middle term too long.");
+    limbs_add(out + h, na + nb - h, z1.data(), len);
+}
+
+BigNumber::BigNumber(i64 value) {
+    if (value != 0) {
+        _negative = value < 0;
+        _size = 1;
+        // The magnitude in u64, so the minimum i64 does not overflow.
+        _inline[0] = _negative ? 0 - static_cast<u64>(value) : static_cast<u64>(value);
+    }
+}
+
+BigNumber::BigNumber(std::string_view text) {
+    const bool negative = !text.empty() && text[0] == '-';
+    if (negative) {
+        text.remove_prefix(1);
+    }
+    assert((!text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; }))
+        && "Not a decimal number.");
+
+    *this = parse_digits(text);
+    _negative = negative && _size > 0;
+}
+
+BigNumber::BigNumber(const BigNumber& other)
+    : _negative{ other._negative }, _str{ other._str } {
+    resize(other._size);
+    std::copy(other.limbs(), other.limbs() + other._size, limbs());
+}
+
+BigNumber::BigNumber(BigNumber&& other) noexcept
+    : _size{ other._size }, _capacity{ other._capacity }, _negative{ other._negative },
+    _inline{ other._inline }, _heap{ std::move(other._heap) }, _str{ std::move(other._str) } {
+    other._size = 0;
+    other._capacity = BIGNUM_INLINE_LIMBS;
+    other._negative = false;
+    other._str.clear();
+}
+
+BigNumber& BigNumber::operator=(const BigNumber& other) {
+    if (this != &other) {
+        _size = 0;
+        resize(other._size);
+        std::copy(other.limbs(), other.limbs() + other._size, limbs());
+        _negative = other._negative;
+        _str = other._str;
+    }
+    return *this;
+}
+
+BigNumber& BigNumber::operator=(BigNumber&& other) noexcept {
+    if (this != &other) {
+        _size = other._size;
+        _capacity = other._capacity;
+        _negative = other._negative;
+        _inline = other._inline;
+        _heap = std::move(other._heap);
+        _str = std::move(other._str);
+        other._size = 0;
+        other._capacity = BIGNUM_INLINE_LIMBS;
+        other._negative = false;
+        other._str.clear();
+    }
+    return *this;
+}
+
+void BigNumber::resize(u64 size) {
+    if (size > _capacity) {
+        const u64 capacity = std::max(size, 2 * _capacity);
+        std::unique_ptr<u64[]> heap(new u64[capacity]);
+        std::copy(limbs(), limbs() + _size, heap.get());
+        _heap = std::move(heap);
+        _capacity = capacity;
+    }
+    if (size > _size) {
+        std::fill(limbs() + _size, limbs() + size, 0);
+    }
+    _size = size;
+}
+
+void BigNumber::trim() {
+    while (_size > 0 && limbs()[_size - 1] == 0) {
+        --_size;
+    }
+    if (_size == 0) {
+        _negative = false;
+    }
+}
+
+bool BigNumber::operator==(const BigNumber& other) const {
+    return _negative == other._negative && compare_magnitudes(*this, other) == 0;
+}
+
+std::strong_ordering BigNumber::operator<=>(const BigNumber& other) const {
+    if (_negative != other._negative) {
+        return _negative ? std::strong_ordering::less : std::strong_ordering::greater;
+    }
+    const i32 cmp = _negative ? compare_magnitudes(other, *this) : compare_magnitudes(*this, other);
+    return cmp <=> 0;
+}
+
+i32 BigNumber::compare_magnitudes(const BigNumber& a, const BigNumber& b) {
+    if (a._size != b._size) {
+        return a._size < b._size ? -1 : 1;
+    }
+    for (u64 i = a._size; i-- > 0;) {
+        if (a.limbs()[i] != b.limbs()[i]) {
+            return a.limbs()[i] < b.limbs()[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+BigNumber BigNumber::add_magnitudes(const BigNumber& a, const BigNumber& b) {
+    const BigNumber& longer = a._size >= b._size ? a : b;
+    const BigNumber& shorter = a._size >= b._size ? b : a;
+
+    BigNumber res;
+    res.resize(longer._size + 1);
+    std::copy(longer.limbs(), longer.limbs() + longer._size, res.limbs());
+    limbs_add(res.limbs(), res._size, shorter.limbs(), shorter._size);
+    res.trim();
+    return res;
+}
+
+BigNumber BigNumber::sub_magnitudes(const BigNumber& a, const BigNumber& b) {
+    BigNumber res;
+    res.resize(a._size);
+    std::copy(a.limbs(), a.limbs() + a._size, res.limbs());
+    limbs_sub(res.limbs(), res._size, b.limbs(), b._size);
+    res.trim();
+    return res;
+}
+
+BigNumber BigNumber::operator-() const {
+    BigNumber res = *this;
+    res._negative = !_negative && _size > 0;
+    res._str.clear();
+    return res;
+}
+
+BigNumber BigNumber::operator+(const BigNumber& other) const {
+    if (_negative == other._negative) {
+        BigNumber res = add_magnitudes(*this, other);
+        res._negative = _negative;
+        return res;
+    }
+    const bool this_larger = compare_magnitudes(*this, other) >= 0;
+    BigNumber res = this_larger ? sub_magnitudes(*this, other) : sub_magnitudes(other, *this);
+    res._negative = (this_larger ? _negative : other._negative) && res._size > 0;
+    return res;
+}
+
+BigNumber BigNumber::operator-(const BigNumber& other) const {
+    return *this + (-other);
+}
+
+BigNumber BigNumber::operator*(const BigNumber& other) const {
+    BigNumber res;
+    if (_size == 0 || other._size == 0) {
+        return res;
+    }
+    res.resize(_size + other._size);
+    limbs_mul(res.limbs(), limbs(), _size, other.limbs(), other._size);
+    res._negative = _negative != other._negative;
+    res.trim();
+    return res;
+}
+
+BigNumber BigNumber::operator<<(u64 bits) const {
+    BigNumber res;
+    if (_size == 0) {
+        return res;
+    }
+    const u64 words = bits / 64;
+    const u64 shift = bits % 64;
+    res.resize(_size + words + 1);
+    for (u64 i = 0; i < _size; ++i) {
+        res.limbs()[i + words] |= limbs()[i] << shift;
+        if (shift > 0) {
+            res.limbs()[i + words + 1] |= limbs()[i] >> (64 - shift);
+        }
+    }
+    res._negative = _negative;
+    res.trim();
+    return res;
+}
+
+BigNumber BigNumber::operator>>(u64 bits) const {
+    BigNumber res;
+    const u64 words = bits / 64;
+    const u64 shift = bits % 64;
+    if (words >= _size) {
+        return res;
+    }
+    res.resize(_size - words);
+    for (u64 i = 0; i < res._size; ++i) {
+        u64 limb = limbs()[i + words] >> shift;
+        if (shift > 0 && i + words + 1 < _size) {
+            limb |= limbs()[i + words + 1] << (64 - shift);
+        }
+        res.limbs()[i] = limb;
+    }
+    res._negative = _negative;
+    res.trim();
+    return res;
+}
+
+bool BigNumber::fits_i64() const {
+    if (_size == 0) {
+        return true;
+    }
+    return _size == 1 && limbs()[0] <= (_negative ? 1ull << 63 : (1ull << 63) - 1);
+}
+
+i64 BigNumber::get_i64() const {
+    assert(fits_i64() && "Value does not fit an i64.");
+    if (_size == 0) {
+        return 0;
+    }
+    return static_cast<i64>(_negative ? 0 - limbs()[0] : limbs()[0]);
+}
+
+u64 BigNumber::get_bits() const {
+    return _size == 0 ? 0 : 64 * (_size - 1) + std::bit_width(limbs()[_size - 1]);
+}
+
+u32 BigNumber::divide_small(u32 divisor) {
+    // Half limbs, so every step divides a 64 bit value.
+    u64 rem = 0;
+    for (u64 i = _size; i-- > 0;) {
+        const u64 limb = limbs()[i];
+        const u64 high = (rem << 32) | (limb >> 32);
+        rem = high % divisor;
+        const u64 low = (rem << 32) | (limb & 0xFFFFFFFF);
+        rem = low % divisor;
+        limbs()[i] = ((high / divisor) << 32) | (low / divisor);
+    }
+    trim();
+    return static_cast<u32>(rem);
+}
+
+void BigNumber::multiply_add_small(u32 factor, u32 addend) {
+    u64 carry = addend;
+    for (u64 i = 0; i < _size; ++i) {
+        u64 high;
+        u64 low = mul_wide(limbs()[i], factor, high);
+        low += carry;
+        high += low < carry;
+        limbs()[i] = low;
+        carry = high;
+    }
+    if (carry > 0) {
+        resize(_size + 1);
+        limbs()[_size - 1] = carry;
+    }
+}
+
+// floor(2^(2k) / d) for the k bit d by Newton iteration x' = x (2^(2k+1) - d x) / 2^(2k). The
+// start is below the root and every step stays below, so the iteration stops when x stops
+// growing and a few corrections finish it.
+BigNumber reciprocal(const BigNumber& d) {
+    const u64 k = d.get_bits();
+    assert((k > 53) && "Reciprocal of a small divisor.");
+
+    // The top 53 bits of d as a double give the first 50 bits of the reciprocal.
+    const f64 top = static_cast<f64>((d >> (k - 53)).limbs()[0]);
+    const f64 y = 0x1.0p105 / top;
+    BigNumber x = BigNumber(static_cast<i64>(y) - 2) << (k - 52);
+
+    const BigNumber two_scale = BigNumber(1) << (2 * k + 1);
+    while (true) {
+        BigNumber next = (x * (two_scale - d * x)) >> (2 * k);
+        if (next <= x) {
+            break;
+        }
+        x = std::move(next);
+    }
+
+    const BigNumber one(1);
+    BigNumber r = (BigNumber(1) << (2 * k)) - d * x;
+    while (r.is_negative()) {
+        r += d;
+        x -= one;
+    }
+    while (r >= d) {
+        r -= d;
+        x += one;
+    }
+    return x;
+}
+
+// Barrett division, x < 2^(2 bits). The estimate is at most a few below the quotient.
+void divide_by_power(const BigNumber& x, const DecimalPower& p, BigNumber& q, BigNumber& r) {
+    q = (x * p.inverse) >> (2 * p.bits);
+    r = x - q * p.power;
+    const BigNumber one(1);
+    while (r >= p.power) {
+        r -= p.power;
+        q += one;
+    }
+}
+
+const DecimalPower& get_decimal_power(u64 level) {
+    static std::mutex mutex;
+    static std::deque<DecimalPower> powers;
+
+    std::lock_guard lock(mutex);
+    while (powers.size() <= level) {
+        BigNumber power = powers.empty() ? BigNumber(1'000'000'000'000'000'000) : powers.back().power * powers.back().power;
+        BigNumber inverse = reciprocal(power);
+        const u64 bits = power.get_bits();
+        powers.push_back({ std::move(power), std::move(inverse), bits, BIGNUM_POWER_DIGITS << powers.size() });
+    }
+    return powers[level];
+}
+
+// Appends |x| < 10^(18 * 2^(level + 1)), left padded with zeros to `pad` digits, 0 means no
+// padding.
+void BigNumber::write_digits(const BigNumber& x, u64 level, u64 pad, std::string& out) {
+    if (x._size <= BIGNUM_DECIMAL_THRESHOLD) {
+        char buffer[BIGNUM_DECIMAL_THRESHOLD * 20];
+        char* end = buffer + sizeof(buffer);
+        char* begin = end;
+        BigNumber rest = x;
+        while (!rest.is_zero()) {
+            u32 chunk = rest.divide_small(1'000'000'000);
+            for (u64 d = 0; d < 9 && (chunk > 0 || !rest.is_zero()); ++d) {
+                *--begin = static_cast<char>('0' + chunk % 10);
+                chunk /= 10;
+            }
+        }
+        const u64 len = static_cast<u64>(end - begin);
+        if (pad > len) {
+            out.append(pad - len, '0');
+        }
+        else if (pad == 0 && len == 0) {
+            out.push_back('0');
+        }
+        out.append(begin, end);
+        return;
+    }
+
+    const DecimalPower& p = get_decimal_power(level);
+    BigNumber q(0);
+    BigNumber r(0);
+    divide_by_power(x, p, q, r);
+    if (pad == 0 && q.is_zero()) {
+        // The level is chosen by bit length, the leading half may be empty.
+        write_digits(r, level - 1, 0, out);
+        return;
+    }
+    write_digits(q, level - 1, pad > 0 ? pad - p.digits : 0, out);
+    write_digits(r, level - 1, p.digits, out);
+}
+
+std::string_view BigNumber::get_str() const {
+    if (_str.empty()) {
+        // The smallest level whose square power is above |x|.
+        const u64 bits = get_bits();
+        u64 level = 0;
+        while (_size > BIGNUM_DECIMAL_THRESHOLD && 2 * get_decimal_power(level).bits - 2 < bits) {
+            ++level;
+        }
+
+        BigNumber magnitude = *this;
+        magnitude._negative = false;
+        if (_negative) {
+            _str.push_back('-');
+        }
+        write_digits(magnitude, level, 0, _str);
+    }
+    return _str;
+}
+
+// The digits split in halves at a power of ten, hi * 10^(18 * 2^j) + lo, mirrors write_digits().
+BigNumber BigNumber::parse_digits(std::string_view digits) {
+    if (digits.size() <= BIGNUM_DECIMAL_THRESHOLD * BIGNUM_POWER_DIGITS) {
+        BigNumber res(0);
+        constexpr u32 powers[] = { 1, 10, 100, 1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000, 1'000'000'000 };
+        for (u64 i = 0; i < digits.size(); i += 9) {
+            const u64 len = std::min<u64>(9, digits.size() - i);
+            u32 chunk = 0;
+            for (u64 j = i; j < i + len; ++j) {
+                chunk = chunk * 10 + static_cast<u32>(digits[j] - '0');
+            }
+            if (res.is_zero()) {
+                res = BigNumber(static_cast<i64>(chunk));
+            }
+            else {
+                res.multiply_add_small(powers[len], chunk);
+            }
+        }
+        return res;
+    }
+
+    u64 level = 0;
+    while ((BIGNUM_POWER_DIGITS << (level + 1)) < digits.size()) {
+        ++level;
+    }
+    const DecimalPower& p = get_decimal_power(level);
+    const u64 split = digits.size() - p.digits;
+    return parse_digits(digits.substr(0, split)) * p.power + parse_digits(digits.substr(split));
+}
+
+void bench_bignum(u64 digits) {
+    using clock_t = std::chrono::steady_clock;
+
+    auto seconds = [](clock_t::time_point start) {
+        return std::chrono::duration<f64>(clock_t::now() - start).count();
+    };
+
+    // Repeated squaring of 3 up to the size, then a multiply by 7 breaks the pattern.
+    BigNumber a(3);
+    while (a.get_bits() * 3 < digits * 10) {
+        a *= a;
+    }
+    a *= BigNumber(7);
+    const BigNumber b = a + BigNumber(12345);
+    std::cout << a.get_limbs() << " limbs\n";
+
+    auto start = clock_t::now();
+    BigNumber schoolbook;
+    schoolbook.resize(a._size + b._size);
+    limbs_mul_basecase(schoolbook.limbs(), a.limbs(), a._size, b.limbs(), b._size);
+    schoolbook.trim();
+    std::cout << "    schoolbook product: " << seconds(start) * 1e3 << " ms\n";
+
+    start = clock_t::now();
+    const BigNumber product = a * b;
+    std::cout << "    karatsuba product: " << seconds(start) * 1e3 << " ms, same result: " << (product == schoolbook) << "\n";
+
+    // Every 9 digits divide the whole rest once more.
+    start = clock_t::now();
+    std::string naive;
+    BigNumber rest = a;
+    while (!rest.is_zero()) {
+        u32 chunk = rest.divide_small(1'000'000'000);
+        for (u64 d = 0; d < 9 && (chunk > 0 || !rest.is_zero()); ++d) {
+            naive.push_back(static_cast<char>('0' + chunk % 10));
+            chunk /= 10;
+        }
+    }
+    std::reverse(naive.begin(), naive.end());
+    std::cout << "    repeated division to decimal: " << seconds(start) * 1e3 << " ms\n";
+
+    // The powers of ten are cached by the first call, the second one is timed.
+    BigNumber(a).get_str();
+    start = clock_t::now();
+    const BigNumber copy = a;
+    const std::string_view text = copy.get_str();
+    std::cout << "    divide and conquer to decimal: " << seconds(start) * 1e3 << " ms, " << text.size()
+        << " digits, same result: " << (text == naive) << "\n";
+
+    start = clock_t::now();
+    const BigNumber parsed(text);
+    std::cout << "    parse: " << seconds(start) * 1e3 << " ms, same value: " << (parsed == a) << "\n";
+}
\ No newline at end of file
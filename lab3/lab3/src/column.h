@@ -0,0 +1,252 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string_view>
+#include <charconv>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <cassert>
+
+#include "defines.h"
+#include "number.h"
+
+// Structure of arrays storage for Numbers: the values are one contiguous i64 array and the text
+// lives in a separate arena indexed by offsets. Scans over the values touch 8 bytes per element.
+// The arena is written for the whole column on the first get_str() call and dropped by every
+// change of the values.
+class NumberColumn {
+public:
+    NumberColumn() = default;
+    explicit NumberColumn(const std::vector<Number>& numbers);
+    template<typename It>
+    NumberColumn(It first, It last);
+public:
+    u64 get_size() const { return _values.size(); }
+    bool empty() const { return _values.empty(); }
+    void reserve(u64 size) { _values.reserve(size); }
+    void clear();
+
+    void push_back(i64 value);
+    void push_back(const Number& number) { push_back(number.get_i64()); }
+
+    i64 operator[](u64 idx) const { return _values[idx]; }
+    Number get(u64 idx) const { return Number(_values[idx]); }
+    std::string_view get_str(u64 idx) const;
+    std::vector<Number> to_numbers() const;
+public:
+    // The value column, sorting or rewriting it through these drops the text arena.
+    i64* begin() { invalidate_text(); return _values.data(); }
+    i64* end() { return _values.data() + _values.size(); }
+    const i64* begin() const { return _values.data(); }
+    const i64* end() const { return _values.data() + _values.size(); }
+    const i64* data() const { return _values.data(); }
+public:
+    f64 sum() const;
+    f64 mean() const;
+    template<typename Pred>
+    u64 count_if(Pred pred) const;
+    template<typename Compare = std::less<>>
+    void sort(Compare comp = {});
+    // Stable, returns the number of values that satisfy `pred`, they end up in front.
+    template<typename Pred>
+    u64 stable_partition(Pred pred);
+    // Removes the values that satisfy `pred`, the order of the rest is kept.
+    template<typename Pred>
+    void erase_if(Pred pred);
+private:
+    void invalidate_text() { _offsets.clear(); _arena.clear(); }
+private:
+    std::vector<i64> _values;
+    mutable std::vector<u64> _offsets;
+    mutable std::vector<char> _arena;
+};
+
+// Times sort, mean, partition and the odd erase on a vector of Numbers and on a NumberColumn.
+void bench_column(u64 size);
+
+//
+
+NumberColumn::NumberColumn(const std::vector<Number>& numbers)
+    : NumberColumn(numbers.begin(), numbers.end()) {}
+
+template<typename It>
+NumberColumn::NumberColumn(It first, It last) {
+    for (; first != last; ++first) {
+        push_back(*first);
+    }
+}
+
+void NumberColumn::clear() {
+    _values.clear();
+    invalidate_text();
+}
+
+void NumberColumn::push_back(i64 value) {
+    _values.push_back(value);
+    invalidate_text();
+}
+
+std::string_view NumberColumn::get_str(u64 idx) const {
+    assert((idx < _values.size()) && "Index out of range.");
+
+    if (_offsets.size() != _values.size() + 1) {
+        _arena.resize(_values.size() * NUMBER_STR_SIZE);
+        _offsets.resize(_values.size() + 1);
+        char* out = _arena.data();
+        _offsets[0] = 0;
+        for (u64 i = 0; i < _values.size(); ++i) {
+            out = std::to_chars(out, _arena.data() + _arena.size(), _values[i]).ptr;
+            _offsets[i + 1] = static_cast<u64>(out - _arena.data());
+        }
+        _arena.resize(_offsets.back());
+    }
+
+    return { _arena.data() + _offsets[idx], _offsets[idx + 1] - _offsets[idx] };
+}
+
+std::vector<Number> NumberColumn::to_numbers() const {
+    std::vector<Number> res;
+    res.reserve(_values.size());
+    for (i64 value : _values) {
+        res.emplace_back(value);
+    }
+    return res;
+}
+
+f64 NumberColumn::sum() const {
+    // Four independent accumulators break the add dependency chain, the compiler keeps them in
+    // one vector register. The lanes are combined in a fixed order.
+    f64 acc[4] = { 0.0, 0.0, 0.0, 0.0 };
+    const u64 size = _values.size();
+    const i64* v = _values.data();
+
+    u64 i = 0;
+    for (; i + 4 <= size; i += 4) {
+        acc[0] += static_cast<f64>(v[i]);
+        acc[1] += static_cast<f64>(v[i + 1]);
+        acc[2] += static_cast<f64>(v[i + 2]);
+        acc[3] += static_cast<f64>(v[i + 3]);
+    }
+    for (; i < size; ++i) {
+        acc[0] += static_cast<f64>(v[i]);
+    }
+
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+f64 NumberColumn::mean() const {
+    return _values.empty() ? 0.0 : sum() / static_cast<f64>(_values.size());
+}
+
+template<typename Pred>
+u64 NumberColumn::count_if(Pred pred) const {
+    u64 count = 0;
+    for (i64 value : _values) {
+        count += pred(value) ? 1 : 0;
+    }
+    return count;
+}
+
+template<typename Compare>
+void NumberColumn::sort(Compare comp) {
+    std::sort(_values.begin(), _values.end(), comp);
+    invalidate_text();
+}
+
+template<typename Pred>
+u64 NumberColumn::stable_partition(Pred pred) {
+    // Branch free: every value is written to both outputs and only the matching cursor moves.
+    std::vector<i64> rest(_values.size());
+    u64 yes = 0;
+    u64 no = 0;
+    for (u64 i = 0; i < _values.size(); ++i) {
+        const i64 value = _values[i];
+        const bool hit = pred(value);
+        _values[yes] = value;
+        rest[no] = value;
+        yes += hit;
+        no += !hit;
+    }
+    std::copy(rest.begin(), rest.begin() + no, _values.begin() + yes);
+    invalidate_text();
+    return yes;
+}
+
+template<typename Pred>
+void NumberColumn::erase_if(Pred pred) {
+    u64 kept = 0;
+    for (u64 i = 0; i < _values.size(); ++i) {
+        const i64 value = _values[i];
+        _values[kept] = value;
+        kept += !pred(value);
+    }
+    _values.resize(kept);
+    invalidate_text();
+}
+
+void bench_column(u64 size) {
+    using clock_t = std::chrono::steady_clock;
+
+    std::mt19937 mt;
+    std::vector<Number> numbers;
+    numbers.reserve(size);
+    for (u64 i = 0; i < size; ++i) {
+        numbers.emplace_back(mt());
+    }
+    NumberColumn column(numbers);
+
+    auto report = [](const char* name, clock_t::time_point start) {
+        std::cout << "    " << name << ": " << std::chrono::duration<f64>(clock_t::now() - start).count() * 1e3 << " ms\n";
+    };
+
+    std::cout << "std::vector<Number>, " << size << " elements\n";
+    auto start = clock_t::now();
+    std::sort(numbers.begin(), numbers.end(), [](const Number& n1, const Number& n2) {
+        return n1.get_i64() > n2.get_i64();
+    });
+    report("sort", start);
+
+    start = clock_t::now();
+    const f64 mean_value = std::accumulate(numbers.begin(), numbers.end(), 0.0, [](f64 sum, const Number& elem) {
+        return sum + elem.get_i64();
+    }) / static_cast<f64>(size);
+    report("mean", start);
+
+    start = clock_t::now();
+    std::stable_partition(numbers.begin(), numbers.end(), [mean_value](const Number& elem) {
+        return elem.get_i64() > mean_value;
+    });
+    report("partition", start);
+
+    start = clock_t::now();
+    numbers.erase(std::remove_if(numbers.begin(), numbers.end(), [](const Number& elem) {
+        return elem.get_i64() % 2 != 0;
+    }), numbers.end());
+    report("erase odd", start);
+
+    std::cout << "NumberColumn, " << size << " elements\n";
+    start = clock_t::now();
+    column.sort(std::greater<>());
+    report("sort", start);
+
+    start = clock_t::now();
+    const f64 column_mean = column.mean();
+    report("mean", start);
+
+    start = clock_t::now();
+    column.stable_partition([column_mean](i64 value) { return value > column_mean; });
+    report("partition", start);
+
+    start = clock_t::now();
+    column.erase_if([](i64 value) { return value % 2 != 0; });
+    report("erase odd", start);
+
+    std::cout << "same result: " << (column.get_size() == numbers.size()
+        && std::equal(column.begin(), column.end(), numbers.begin(), [](i64 value, const Number& elem) {
+            return value == elem.get_i64();
+        })) << "\n";
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <iostream>
+#include <array>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+#include "defines.h"
+
+// Build with NUMBER_COUNTERS=1 (/D or -D) to count what happens to Numbers. Without it
+// count_event() is empty and the reporters print nothing.
+#ifndef NUMBER_COUNTERS
+#define NUMBER_COUNTERS 0
+#endif
+
+enum class Counter : u32 {
+    CONSTRUCT = 0,   // from a value
+    COPY = 1,
+    MOVE = 2,
+    COPY_ASSIGN = 3,
+    MOVE_ASSIGN = 4,
+    DESTROY = 5,
+    STRING = 6,      // text written by get_str()
+};
+
+constexpr u64 COUNTER_COUNT = 7;
+constexpr std::array<const char*, COUNTER_COUNT> COUNTER_NAMES = {
+    "constructions", "copies", "moves", "copy_assignments", "move_assignments", "destructions", "strings",
+};
+
+struct CounterSnapshot {
+    std::array<u64, COUNTER_COUNT> values{};
+
+    u64 operator[](Counter counter) const { return values[static_cast<u64>(counter)]; }
+    CounterSnapshot operator-(const CounterSnapshot& other) const;
+};
+
+std::ostream& operator<<(std::ostream& out, const CounterSnapshot& snapshot);
+
+// Every thread counts in its own block, so counting is a plain increment without a lock or a
+// read-modify-write.
+void count_event(Counter counter);
+
+// Sum of the blocks of all threads, including the threads that have finished. The blocks are
+// read while their threads count, so a snapshot may miss the last few events of a busy thread.
+CounterSnapshot get_counters();
+
+// Prints the events of every named stage to `out` when the stage ends: at next() and at the end
+// of the scope.
+class ScopedCounters {
+public:
+    explicit ScopedCounters(const char* name, std::ostream& out = std::cerr);
+    ScopedCounters(const ScopedCounters&) = delete;
+    ScopedCounters& operator=(const ScopedCounters&) = delete;
+    ~ScopedCounters();
+public:
+    void next(const char* name);
+private:
+#if NUMBER_COUNTERS
+    void report();
+private:
+    const char* _name;
+    std::ostream& _out;
+    CounterSnapshot _start;
+#endif
+};
+
+//
+
+CounterSnapshot CounterSnapshot::operator-(const CounterSnapshot& other) const {
+    CounterSnapshot res;
+    for (u64 c = 0; c < COUNTER_COUNT; ++c) {
+        res.values[c] = values[c] - other.values[c];
+    }
+    return res;
+}
+
+std::ostream& operator<<(std::ostream& out, const CounterSnapshot& snapshot) {
+    for (u64 c = 0; c < COUNTER_COUNT; ++c) {
+        out << (c == 0 ? "" : ", ") << COUNTER_NAMES[c] << " " << snapshot.values[c];
+    }
+    return out;
+}
+
+#if NUMBER_COUNTERS
+
+struct CounterBlock {
+    std::array<std::atomic<u64>, COUNTER_COUNT> values{};
+};
+
+class CounterRegistry {
+public:
+    CounterBlock* add() {
+        std::lock_guard lock(_mutex);
+        _blocks.push_back(std::make_unique<CounterBlock>());
+        return _blocks.back().get();
+    }
+
+    CounterSnapshot sum() {
+        std::lock_guard lock(_mutex);
+        CounterSnapshot res;
+        for (const auto& block : _blocks) {
+            for (u64 c = 0; c < COUNTER_COUNT; ++c) {
+                res.values[c] += block->values[c].load(std::memory_order_relaxed);
+            }
+        }
+        return res;
+    }
+private:
+    std::mutex _mutex;
+    std::vector<std::unique_ptr<CounterBlock>> _blocks;
+};
+
+// Never destroyed, Numbers in static storage are counted after main() returns.
+CounterRegistry& get_counter_registry() {
+    static CounterRegistry* registry = new CounterRegistry();
+    return *registry;
+}
+
+void count_event(Counter counter) {
+    thread_local CounterBlock* block = get_counter_registry().add();
+    // Only this thread writes the block, the atomic is for the readers of get_counters().
+    std::atomic<u64>& value = block->values[static_cast<u64>(counter)];
+    value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+CounterSnapshot get_counters() {
+    return get_counter_registry().sum();
+}
+
+ScopedCounters::ScopedCounters(const char* name, std::ostream& out)
+    : _name{ name }, _out{ out }, _start{ get_counters() } {}
+
+ScopedCounters::~ScopedCounters() {
+    report();
+}
+
+void ScopedCounters::next(const char* name) {
+    report();
+    _name = name;
+    _start = get_counters();
+}
+
+void ScopedCounters::report() {
+    _out << _name << ": " << (get_counters() - _start) << "\n";
+}
+
+#else
+
+void count_event(Counter) {}
+
+CounterSnapshot get_counters() {
+    return {};
+}
+
+ScopedCounters::ScopedCounters(const char*, std::ostream&) {}
+
+ScopedCounters::~ScopedCounters() {}
+
+void ScopedCounters::next(const char*) {}
+
+#endif
\ No newline at end of file
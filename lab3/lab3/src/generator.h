@@ -0,0 +1,192 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <cassert>
+
+#include "defines.h"
+#include "number.h"
+#include "pool.h"
+
+constexpr u64 GENERATE_GRAIN = 1 << 16;
+
+enum class Distribution : u32 {
+    UNIFORM = 0,     // every value of [min, max] equally likely
+    ZIPF = 1,        // value min + k - 1 with probability proportional to 1 / k^zipf_exponent, k in [1, distinct]
+    SORTED_RUNS = 2, // ascending runs of run_length values, every run spans [min, max] again
+    DUPLICATES = 3,  // `distinct` values spread evenly over [min, max], drawn uniformly
+};
+
+constexpr u64 DISTRIBUTION_COUNT = 4;
+constexpr std::array<const char*, DISTRIBUTION_COUNT> DISTRIBUTION_NAMES = { "uniform", "zipf", "sorted_runs", "duplicates" };
+
+struct GeneratorOptions {
+    Distribution distribution{ Distribution::UNIFORM };
+    u64 seed{ 5489 };
+    i64 min{ 0 };
+    i64 max{ 0xFFFFFFFF };
+    f64 zipf_exponent{ 1.0 };
+    u64 distinct{ 1000 };
+    u64 run_length{ 1 << 12 };
+};
+
+// Counter based generator: the value for (seed, counter) is a SplitMix64 style hash of the pair,
+// so any element of any stream is computed without the elements before it.
+u64 counter_random(u64 seed, u64 counter);
+
+// Element `i` of the stream described by `options`. Depends only on the options and `i`.
+i64 generate_value(const GeneratorOptions& options, u64 i);
+
+// Writes elements [offset, offset + count) of the stream into `out`, which must hold `count`
+// elements. Slices are spread over the pool, the result does not depend on the thread count.
+template<typename T>
+void generate(ThreadPool& pool, T* out, u64 count, const GeneratorOptions& options, u64 offset = 0);
+
+template<typename T>
+void generate(ThreadPool& pool, std::vector<T>& out, const GeneratorOptions& options, u64 offset = 0);
+
+// Generates `size` Numbers with every distribution on one thread and on the pool, printing the
+// throughput and whether both runs produced the same values.
+void bench_generator(u64 size, u64 threads = 0);
+
+//
+
+u64 splitmix64(u64 x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+u64 counter_random(u64 seed, u64 counter) {
+    // The seed is mixed once more than the counter, so (seed, counter) and (counter, seed) differ.
+    return splitmix64(splitmix64(seed) ^ counter);
+}
+
+// High 64 bits of a * b.
+u64 mul_high(u64 a, u64 b) {
+    const u64 a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+    const u64 b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+    const u64 lo_lo = a_lo * b_lo;
+    const u64 hi_lo = a_hi * b_lo;
+    const u64 lo_hi = a_lo * b_hi;
+    const u64 cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    return a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+}
+
+// Uniform in [0, bound) by a multiply instead of a modulo, bound == 0 stands for 2^64.
+u64 random_below(u64 random, u64 bound) {
+    return bound == 0 ? random : mul_high(random, bound);
+}
+
+f64 random_unit(u64 random) {
+    return static_cast<f64>(random >> 11) * 0x1.0p-53;
+}
+
+// Zipf rank in [1, n] by Hörmann's rejection inversion. A rejected try moves to the next
+// sub counter, the accepted rank is the same whatever thread draws it.
+u64 zipf_rank(u64 seed, u64 i, u64 n, f64 s) {
+    auto helper1 = [](f64 x) { return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x / 3.0); };
+    auto helper2 = [](f64 x) { return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0); };
+    auto h = [s](f64 x) { return std::exp(-s * std::log(x)); };
+    auto h_integral = [&](f64 x) { const f64 log_x = std::log(x); return helper2((1.0 - s) * log_x) * log_x; };
+    auto h_integral_inverse = [&](f64 x) {
+        f64 t = std::max(-1.0, x * (1.0 - s));
+        return std::exp(helper1(t) * x);
+    };
+
+    const f64 integral_x1 = h_integral(1.5) - 1.0;
+    const f64 integral_n = h_integral(static_cast<f64>(n) + 0.5);
+    const f64 threshold = 2.0 - h_integral_inverse(h_integral(2.5) - h(2.0));
+
+    for (u64 attempt = 0;; ++attempt) {
+        const f64 u = integral_n + random_unit(counter_random(seed + attempt, i)) * (integral_x1 - integral_n);
+        const f64 x = h_integral_inverse(u);
+        const u64 k = std::clamp<u64>(static_cast<u64>(x + 0.5), 1, n);
+        if (static_cast<f64>(k) - x <= threshold || u >= h_integral(static_cast<f64>(k) + 0.5) - h(static_cast<f64>(k))) {
+            return k;
+        }
+    }
+}
+
+// min + offset in u64, where it wraps instead of overflowing, for ranges wider than 2^63.
+i64 offset_value(i64 min, u64 offset) {
+    return static_cast<i64>(static_cast<u64>(min) + offset);
+}
+
+i64 generate_value(const GeneratorOptions& options, u64 i) {
+    assert((options.min <= options.max) && "Empty value range.");
+
+    const u64 span = static_cast<u64>(options.max) - static_cast<u64>(options.min) + 1; // 0 is the full 2^64
+    const u64 random = counter_random(options.seed, i);
+
+    switch (options.distribution) {
+    case Distribution::UNIFORM:
+        return offset_value(options.min, random_below(random, span));
+    case Distribution::ZIPF: {
+        const u64 rank = zipf_rank(options.seed, i, std::max<u64>(1, options.distinct), options.zipf_exponent);
+        return offset_value(options.min, rank - 1);
+    }
+    case Distribution::SORTED_RUNS: {
+        // The run is cut into run_length equal slots, a value lands in its own slot, so a run
+        // never decreases.
+        const u64 length = std::max<u64>(1, options.run_length);
+        const u64 slot = i % length;
+        const u64 width = span == 0 ? ~0ull / length : span / length;
+        if (width == 0) {
+            // More slots than values: the run climbs through the range, repeating values.
+            return offset_value(options.min, slot * span / length);
+        }
+        return offset_value(options.min, slot * width + random_below(random, width));
+    }
+    case Distribution::DUPLICATES: {
+        const u64 distinct = span == 0 ? std::max<u64>(1, options.distinct) : std::clamp<u64>(options.distinct, 1, span);
+        const u64 stride = span == 0 ? ~0ull / distinct : span / distinct;
+        return offset_value(options.min, random_below(random, distinct) * stride);
+    }
+    }
+    return options.min;
+}
+
+template<typename T>
+void generate(ThreadPool& pool, T* out, u64 count, const GeneratorOptions& options, u64 offset) {
+    pool.parallel_for(0, count, GENERATE_GRAIN, [&](u64 lo, u64 hi) {
+        for (u64 i = lo; i < hi; ++i) {
+            out[i] = T(generate_value(options, offset + i));
+        }
+    });
+}
+
+template<typename T>
+void generate(ThreadPool& pool, std::vector<T>& out, const GeneratorOptions& options, u64 offset) {
+    generate(pool, out.data(), out.size(), options, offset);
+}
+
+void bench_generator(u64 size, u64 threads) {
+    using clock_t = std::chrono::steady_clock;
+
+    ThreadPool serial(1);
+    ThreadPool parallel(threads);
+    std::vector<Number> reference(size, Number(0));
+    std::vector<Number> numbers(size, Number(0));
+
+    for (u32 d = 0; d < DISTRIBUTION_COUNT; ++d) {
+        GeneratorOptions options;
+        options.distribution = static_cast<Distribution>(d);
+
+        for (ThreadPool* pool : { &serial, &parallel }) {
+            std::vector<Number>& out = pool == &serial ? reference : numbers;
+            const auto start = clock_t::now();
+            generate(*pool, out, options);
+            const f64 time = std::chrono::duration<f64>(clock_t::now() - start).count();
+
+            std::cout << DISTRIBUTION_NAMES[d] << ", " << pool->get_threads() << " threads: "
+                << static_cast<f64>(size) / time / 1e6 << " M values/s\n";
+        }
+        std::cout << "    same result: " << (numbers == reference) << "\n";
+    }
+}
\ No newline at end of file
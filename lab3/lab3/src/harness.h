@@ -0,0 +1,116 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <algorithm>
+
+#include "defines.h"
+#include "generator.h"
+#include "pipeline.h"
+#include "pool.h"
+#include "counters.h"
+
+struct HarnessOptions {
+    std::vector<u64> sizes{ 100'000, 1'000'000 };
+    std::vector<Distribution> distributions{ Distribution::UNIFORM };
+    u64 threads{ 1 };
+    // Every configuration runs this many times, the fastest run of every stage is reported.
+    u64 repeats{ 3 };
+};
+
+// Runs the ten lab steps as named stages for every size and distribution and writes one JSON
+// document with the wall time, throughput and allocations of every stage to `out`. Builds with
+// NUMBER_COUNTERS add the Number copies, moves and so on of every stage.
+void run_harness(const HarnessOptions& options, std::ostream& out);
+
+// Empty for a name that is not in DISTRIBUTION_NAMES.
+std::optional<Distribution> parse_distribution(std::string_view name);
+
+// Splits "a,b,c" into its items.
+std::vector<std::string> split_list(std::string_view list);
+
+//
+
+std::optional<Distribution> parse_distribution(std::string_view name) {
+    for (u64 d = 0; d < DISTRIBUTION_COUNT; ++d) {
+        if (name == DISTRIBUTION_NAMES[d]) {
+            return static_cast<Distribution>(d);
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::string> split_list(std::string_view list) {
+    std::vector<std::string> res;
+    while (!list.empty()) {
+        const u64 comma = std::min<u64>(list.find(','), list.size());
+        if (comma > 0) {
+            res.emplace_back(list.substr(0, comma));
+        }
+        list.remove_prefix(std::min<u64>(comma + 1, list.size()));
+    }
+    return res;
+}
+
+void run_harness(const HarnessOptions& options, std::ostream& out) {
+    ThreadPool pool(options.threads);
+
+    out << "{\n  \"threads\": " << pool.get_threads() << ",\n  \"repeats\": " << options.repeats << ",\n  \"runs\": [";
+
+    bool first_run = true;
+    for (Distribution distribution : options.distributions) {
+        for (u64 size : options.sizes) {
+            PipelineOptions pipeline;
+            pipeline.size = size;
+            pipeline.data.distribution = distribution;
+
+            PipelineReport best;
+            for (u64 r = 0; r < std::max<u64>(1, options.repeats); ++r) {
+                PipelineReport report;
+                run_pipeline(pool, pipeline, &report);
+                for (u64 s = 0; s < PIPELINE_STEPS; ++s) {
+                    if (r == 0 || report.seconds[s] < best.seconds[s]) {
+                        best.seconds[s] = report.seconds[s];
+                        best.allocations[s] = report.allocations[s];
+                        best.counters[s] = report.counters[s];
+                    }
+                }
+                best.pairs = report.pairs;
+                best.intersection = report.intersection;
+                best.mean = report.mean;
+            }
+
+            out << (first_run ? "\n" : ",\n");
+            first_run = false;
+            out << "    {\n      \"distribution\": \"" << DISTRIBUTION_NAMES[static_cast<u64>(distribution)] << "\",\n"
+                << "      \"size\": " << size << ",\n"
+                << "      \"seconds\": " << best.get_total() << ",\n"
+                << "      \"pairs\": " << best.pairs << ",\n"
+                << "      \"intersection\": " << best.intersection << ",\n"
+                << "      \"stages\": [";
+            for (u64 s = 0; s < PIPELINE_STEPS; ++s) {
+                // A stage below the clock resolution reports zero throughput, JSON has no infinity.
+                const f64 seconds = best.seconds[s];
+                const f64 throughput = seconds > 0.0 ? static_cast<f64>(size) / seconds : 0.0;
+                out << (s == 0 ? "\n" : ",\n")
+                    << "        { \"name\": \"" << PIPELINE_STEP_NAMES[s] << "\""
+                    << ", \"seconds\": " << seconds
+                    << ", \"elements_per_second\": " << throughput
+                    << ", \"allocations\": " << best.allocations[s].count
+                    << ", \"allocated_bytes\": " << best.allocations[s].bytes;
+                if (NUMBER_COUNTERS) {
+                    for (u64 c = 0; c < COUNTER_COUNT; ++c) {
+                        out << ", \"" << COUNTER_NAMES[c] << "\": " << best.counters[s].values[c];
+                    }
+                }
+                out << " }";
+            }
+            out << "\n      ]\n    }";
+        }
+    }
+
+    out << "\n  ]\n}\n";
+}
\ No newline at end of file
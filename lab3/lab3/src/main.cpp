@@ -1,72 +1,136 @@
 #include <iostream>
 #include <vector>
 #include <list>
-#include <random>
 #include <algorithm>
 #include <numeric>
+#include <string>
 #include "number.h"
+#include "setops.h"
+#include "select.h"
+#include "pipeline.h"
+#include "column.h"
+#include "radix.h"
+#include "pool_list.h"
+#include "generator.h"
+#include "harness.h"
+#include "bignum.h"
 
 int main(int argc, char** argv) {
-    std::mt19937 mt;
-
-    u64 size = static_cast<u64>(mt()) % 501 + 500;
-    std::vector<Number> v1;
-    for (int i = 0; i < size; ++i) {
-        v1.emplace_back(mt());
+    // lab3 --bench [max size] [max threads]: parallel pipeline scaling instead of the lab run.
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        const u64 max_size = argc > 2 ? std::stoull(argv[2]) : 10'000'000;
+        const u64 max_threads = argc > 3 ? std::stoull(argv[3]) : 0;
+        bench_pipeline(max_size, max_threads);
+        return 0;
+    }
+    // lab3 --json [sizes] [distributions] [threads] [repeats]: every step as a stage, one JSON
+    // document on stdout. Sizes and distributions are comma separated lists.
+    if (argc > 1 && std::string(argv[1]) == "--json") {
+        HarnessOptions options;
+        if (argc > 2) {
+            options.sizes.clear();
+            for (const std::string& size : split_list(argv[2])) {
+                options.sizes.push_back(std::stoull(size));
+            }
+        }
+        if (argc > 3) {
+            options.distributions.clear();
+            for (const std::string& name : split_list(argv[3])) {
+                const std::optional<Distribution> distribution = parse_distribution(name);
+                if (!distribution) {
+                    std::cout << "Error: unknown distribution " << name << ".\n";
+                    return 1;
+                }
+                options.distributions.push_back(*distribution);
+            }
+        }
+        options.threads = argc > 4 ? std::stoull(argv[4]) : options.threads;
+        options.repeats = argc > 5 ? std::stoull(argv[5]) : options.repeats;
+        run_harness(options, std::cout);
+        return 0;
+    }
+    // lab3 --column [size]: the single threaded scans on std::vector<Number> and on NumberColumn.
+    if (argc > 1 && std::string(argv[1]) == "--column") {
+        bench_column(argc > 2 ? std::stoull(argv[2]) : 10'000'000);
+        return 0;
     }
+    // lab3 --radix [size] [threads]: std::sort against the radix sort.
+    if (argc > 1 && std::string(argv[1]) == "--radix") {
+        bench_radix(argc > 2 ? std::stoull(argv[2]) : 10'000'000, argc > 3 ? std::stoull(argv[3]) : 0);
+        return 0;
+    }
+    // lab3 --generate [size] [threads]: throughput of every distribution of the data generator.
+    if (argc > 1 && std::string(argv[1]) == "--generate") {
+        bench_generator(argc > 2 ? std::stoull(argv[2]) : 100'000'000, argc > 3 ? std::stoull(argv[3]) : 0);
+        return 0;
+    }
+    // lab3 --bignum [digits]: BigNumber products and decimal conversion.
+    if (argc > 1 && std::string(argv[1]) == "--bignum") {
+        bench_bignum(argc > 2 ? std::stoull(argv[2]) : 100'000);
+        return 0;
+    }
+    // lab3 --lists [size]: the list steps with std::list and with PoolList.
+    if (argc > 1 && std::string(argv[1]) == "--lists") {
+        bench_lists(argc > 2 ? std::stoull(argv[2]) : 10'000'000);
+        return 0;
+    }
+
+    // Number events of every step on stderr, only in builds with NUMBER_COUNTERS.
+    ScopedCounters counters("generate v1");
 
+    GeneratorOptions generator;
+    ThreadPool pool;
+
+    u64 size = counter_random(generator.seed, 0) % 501 + 500;
+    std::vector<Number> v1(size, Number(0));
+    generate(pool, v1, generator, 1);
+
+    counters.next("copy v2");
     u64 b = std::max(static_cast<i64>(0), static_cast<i64>(size) - 200);
     u64 e = size;
 
     std::vector<Number> v2(v1.begin() + b, v1.begin() + e);
 
-    u64 n = static_cast<u64>(mt()) % 31 + 20;
-
-    std::vector<Number> sorted = v1;
+    u64 n = counter_random(generator.seed, size + 1) % 31 + 20;
 
-    std::sort(sorted.begin(), sorted.end(), [](const Number& n1, const Number& n2) {
-        return n1.get_i64() > n2.get_i64();
-    });
+    counters.next("largest of v1");
+    std::vector<Number> largest = top_k(v1, n, &Number::get_i64);
+    PoolList<Number> list1(largest.begin(), largest.end());
 
-    std::list<Number> list1(sorted.begin(), sorted.begin() + n);
+    counters.next("smallest of v2");
+    std::vector<Number> smallest = bottom_k(v2, n, &Number::get_i64);
+    PoolList<Number> list2(smallest.begin(), smallest.end());
 
-    b = std::max(static_cast<i64>(0), static_cast<i64>(size) - static_cast<i64>(n));
-    e = size;
-
-    std::list<Number> list2(sorted.begin() + b, sorted.begin() + e);
-    
-    for (const auto& item : list1) {
-        v1.erase(std::remove(v1.begin(), v1.end(), item), v1.end());
-    }
-    for (const auto& item : list2) {
-        v2.erase(std::remove(v2.begin(), v2.end(), item), v2.end());
-    }
+    counters.next("erase moved");
+    erase_keys(v1, list1);
+    erase_keys(v2, list2);
 
+    counters.next("mean");
     double mean_value = std::accumulate(list1.begin(), list1.end(), 0.0,
         [](double sum, const Number& elem) {
             return sum + elem.get_i64();
         }) / n;
 
-    std::stable_partition(list1.begin(), list1.end(),
+    counters.next("partition");
+    list1.stable_partition(
         [mean_value](const Number& elem) {
             return elem.get_i64() > mean_value;
         });
 
-    list2.erase(std::remove_if(list2.begin(), list2.end(),
+    counters.next("erase odd");
+    list2.remove_if(
         [](const Number& elem) {
             return elem.get_i64() % 2 != 0;
-        }), list2.end());
+        });
 
-    std::vector<Number> v3;
-    for (const auto& item : v1) {
-        if (std::find(v2.begin(), v2.end(), item) != v2.end()) {
-            v3.push_back(item);
-        }
-    }
+    counters.next("intersection");
+    std::vector<Number> v3 = intersection(v1, v2);
 
+    counters.next("pairs");
     size_t min_size = std::min(list1.size(), list2.size());
 
-    std::list<std::pair<Number, Number>> list3;
+    PoolList<std::pair<Number, Number>> list3;
+    list3.reserve(min_size);
 
     auto it1 = list1.begin();
     auto it2 = list2.begin();
@@ -77,6 +141,7 @@ int main(int argc, char** argv) {
         ++it2;
     }
 
+    counters.next("print");
     std::cout << "List 3 pairs:\n";
     for (const auto& pair : list3) {
         std::cout << "(" << pair.first.get_i64() << ", " << pair.second.get_i64() << ")\n";
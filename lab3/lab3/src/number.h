@@ -1,48 +1,85 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <array>
+#include <charconv>
+#include <compare>
+#include <functional>
 #include <iostream>
 
 #include "defines.h"
+#include "counters.h"
+
+// Longest i64 text, "-9223372036854775808".
+constexpr u64 NUMBER_STR_SIZE = 20;
 
 class Number {
 public:
-    explicit Number(i64 value) : _value{ value }, _str{ std::to_string(value) } {
+    explicit Number(i64 value) : _value{ value } {
         //std::cout << "ktor (i64) called." << std::endl;
+        count_event(Counter::CONSTRUCT);
     }
-    Number(const Number& other) : _value{ other._value }, _str{ other._str } {
+    Number(const Number& other) : _value{ other._value }, _len{ other._len }, _chars{ other._chars } {
         //std::cout << "ktor (const Number&) called." << std::endl;
+        count_event(Counter::COPY);
     }
-    Number(Number&& other) noexcept : _value{ other._value }, _str{ std::move(other._str) } {
+    Number(Number&& other) noexcept : _value{ other._value }, _len{ other._len }, _chars{ other._chars } {
         //std::cout << "ktor (Number&&) called." << std::endl;
+        count_event(Counter::MOVE);
     }
     ~Number() {
         //std::cout << "dtor called." << std::endl;
+        count_event(Counter::DESTROY);
     }
 public:
     Number& operator=(const Number& other) {
         //std::cout << "oper (const Number&) called." << std::endl;
+        count_event(Counter::COPY_ASSIGN);
         if (this != &other) {
             _value = other._value;
-            _str = other._str;
+            _len = other._len;
+            _chars = other._chars;
         }
         return *this;
     }
     Number& operator=(Number&& other) {
         //std::cout << "oper (Number&&) called." << std::endl;
+        count_event(Counter::MOVE_ASSIGN);
         if (this != &other) {
             _value = other._value;
-            _str = std::move(other._str);
+            _len = other._len;
+            _chars = other._chars;
         }
         return *this;
     }
     bool operator==(const Number& other) const {
         return _value == other._value;
     }
+    std::strong_ordering operator<=>(const Number& other) const {
+        return _value <=> other._value;
+    }
 public:
     i64 get_i64() const { return _value; }
-    std::string get_str() const { return _str; }
+    // The text is written on the first call and cached inline, the view lives as long as the Number.
+    // The first call writes the cache, so it must not race with another call on the same Number.
+    std::string_view get_str() const {
+        if (_len == 0) {
+            count_event(Counter::STRING);
+            auto [end, ec] = std::to_chars(_chars.data(), _chars.data() + _chars.size(), _value);
+            _len = static_cast<u8>(end - _chars.data());
+        }
+        return { _chars.data(), _len };
+    }
 private:
     i64 _value{ 0 };
-    std::string _str;
+    mutable u8 _len{ 0 };
+    mutable std::array<char, NUMBER_STR_SIZE> _chars{};
+};
+
+template<>
+struct std::hash<Number> {
+    u64 operator()(const Number& number) const noexcept {
+        return std::hash<i64>()(number.get_i64());
+    }
 };
\ No newline at end of file
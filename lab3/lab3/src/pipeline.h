@@ -0,0 +1,194 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <utility>
+#include <chrono>
+#include <algorithm>
+#include <string>
+
+#include "defines.h"
+#include "number.h"
+#include "setops.h"
+#include "pool.h"
+#include "generator.h"
+#include "alloc.h"
+#include "counters.h"
+
+constexpr u64 PIPELINE_STEPS = 10;
+
+constexpr std::array<const char*, PIPELINE_STEPS> PIPELINE_STEP_NAMES = {
+    "generate v1", "copy v2", "largest of v1", "smallest of v2", "erase moved",
+    "mean", "partition", "erase odd", "intersection", "pairs",
+};
+
+// The ten steps of the lab at any size. v2 and n scale with the size like the original
+// 200 of 500-1000 elements and 20-50 of them.
+struct PipelineOptions {
+    u64 size{ 1000 };
+    f64 tail_fraction{ 0.25 };
+    f64 count_fraction{ 0.05 };
+    // Values of v1, the seed and the distribution.
+    GeneratorOptions data{};
+};
+
+struct PipelineReport {
+    std::array<f64, PIPELINE_STEPS> seconds{};
+    // Allocations of every thread during the step.
+    std::array<AllocationStats, PIPELINE_STEPS> allocations{};
+    // Number events during the step, zero unless built with NUMBER_COUNTERS.
+    std::array<CounterSnapshot, PIPELINE_STEPS> counters{};
+    u64 pairs{ 0 };
+    u64 intersection{ 0 };
+    f64 mean{ 0.0 };
+
+    f64 get_total() const;
+};
+
+std::vector<std::pair<Number, Number>> run_pipeline(ThreadPool& pool, const PipelineOptions& options, PipelineReport* report = nullptr);
+
+// Runs the pipeline for every power of ten from 10^5 up to `max_size` and for 1, 2, 4, ...
+// threads up to `max_threads`, printing the throughput of every step.
+void bench_pipeline(u64 max_size, u64 max_threads = 0);
+
+//
+
+f64 PipelineReport::get_total() const {
+    f64 total = 0.0;
+    for (f64 s : seconds) {
+        total += s;
+    }
+    return total;
+}
+
+class StepTimer {
+    using clock_t = std::chrono::steady_clock;
+public:
+    StepTimer(PipelineReport& report)
+        : _report{ report }, _allocations{ get_allocation_stats() }, _counters{ get_counters() }, _start{ clock_t::now() } {}
+public:
+    void next() {
+        const auto now = clock_t::now();
+        const AllocationStats allocations = get_allocation_stats();
+        const CounterSnapshot counters = get_counters();
+        _report.seconds[_step] = std::chrono::duration<f64>(now - _start).count();
+        _report.allocations[_step] = allocations - _allocations;
+        _report.counters[_step] = counters - _counters;
+        ++_step;
+        _allocations = allocations;
+        _counters = counters;
+        _start = now;
+    }
+private:
+    PipelineReport& _report;
+    AllocationStats _allocations;
+    CounterSnapshot _counters;
+    clock_t::time_point _start;
+    u64 _step{ 0 };
+};
+
+std::vector<std::pair<Number, Number>> run_pipeline(ThreadPool& pool, const PipelineOptions& options, PipelineReport* report) {
+    PipelineReport local;
+    StepTimer timer(local);
+
+    const u64 size = options.size;
+    std::vector<Number> v1(size, Number(0));
+    generate(pool, v1, options.data);
+    timer.next();
+
+    const u64 tail = std::min(size, static_cast<u64>(static_cast<f64>(size) * options.tail_fraction));
+    std::vector<Number> v2(v1.end() - tail, v1.end());
+    timer.next();
+
+    const u64 n = std::max<u64>(1, static_cast<u64>(static_cast<f64>(size) * options.count_fraction));
+
+    std::vector<Number> list1 = v1;
+    parallel_sort(pool, list1, [](const Number& n1, const Number& n2) {
+        return n1.get_i64() > n2.get_i64();
+    });
+    list1.resize(std::min<u64>(n, list1.size()), Number(0));
+    timer.next();
+
+    std::vector<Number> list2 = v2;
+    parallel_sort(pool, list2, [](const Number& n1, const Number& n2) {
+        return n1.get_i64() < n2.get_i64();
+    });
+    list2.resize(std::min<u64>(n, list2.size()), Number(0));
+    timer.next();
+
+    {
+        // KeySet lookups are read only, so the threads share one set.
+        const KeySet moved1(list1);
+        const KeySet moved2(list2);
+        parallel_erase_if(pool, v1, [&moved1](const Number& elem) { return moved1.contains(elem); });
+        parallel_erase_if(pool, v2, [&moved2](const Number& elem) { return moved2.contains(elem); });
+    }
+    timer.next();
+
+    const f64 mean_value = list1.empty() ? 0.0 : parallel_sum(pool, list1, &Number::get_i64) / static_cast<f64>(list1.size());
+    timer.next();
+
+    parallel_stable_partition(pool, list1, [mean_value](const Number& elem) {
+        return elem.get_i64() > mean_value;
+    });
+    timer.next();
+
+    parallel_erase_if(pool, list2, [](const Number& elem) {
+        return elem.get_i64() % 2 != 0;
+    });
+    timer.next();
+
+    std::vector<Number> v3 = v1;
+    {
+        const KeySet keys(v2);
+        parallel_erase_if(pool, v3, [&keys](const Number& elem) { return !keys.contains(elem); });
+    }
+    timer.next();
+
+    const u64 min_size = std::min(list1.size(), list2.size());
+    std::vector<std::pair<Number, Number>> list3(min_size, { Number(0), Number(0) });
+    pool.parallel_for(0, min_size, POOL_GRAIN, [&](u64 lo, u64 hi) {
+        for (u64 i = lo; i < hi; ++i) {
+            list3[i] = { list1[i], list2[i] };
+        }
+    });
+    timer.next();
+
+    local.pairs = list3.size();
+    local.intersection = v3.size();
+    local.mean = mean_value;
+    if (report) {
+        *report = local;
+    }
+    return list3;
+}
+
+void bench_pipeline(u64 max_size, u64 max_threads) {
+    if (max_threads == 0) {
+        max_threads = std::max<u64>(1, std::thread::hardware_concurrency());
+    }
+
+    std::vector<u64> thread_counts;
+    for (u64 t = 1; t < max_threads; t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(max_threads);
+
+    for (u64 size = 100'000; size <= max_size; size *= 10) {
+        for (u64 threads : thread_counts) {
+            ThreadPool pool(threads);
+            PipelineOptions options;
+            options.size = size;
+
+            PipelineReport report;
+            run_pipeline(pool, options, &report);
+
+            std::cout << "size " << size << ", threads " << threads << ": "
+                << static_cast<f64>(size) / report.get_total() / 1e6 << " M elements/s\n";
+            for (u64 s = 0; s < PIPELINE_STEPS; ++s) {
+                std::cout << "    " << PIPELINE_STEP_NAMES[s] << ": " << report.seconds[s] * 1e3 << " ms\n";
+            }
+        }
+    }
+}
\ No newline at end of file
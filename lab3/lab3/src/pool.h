@@ -0,0 +1,266 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+
+#include "defines.h"
+
+constexpr u64 POOL_GRAIN = 1 << 14;
+
+// Fixed set of worker threads that all run one job at a time. The calling thread works on the
+// job too, so a pool of one thread runs everything inline.
+class ThreadPool {
+public:
+    explicit ThreadPool(u64 threads = 0);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+public:
+    u64 get_threads() const { return _workers.size() + 1; }
+
+    // Calls f(lo, hi) for consecutive chunks of [begin, end) of at most `grain` items.
+    template<typename F>
+    void parallel_for(u64 begin, u64 end, u64 grain, F f);
+private:
+    void run(const std::function<void()>& job);
+    void work();
+private:
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    const std::function<void()>* _job{ nullptr };
+    u64 _generation{ 0 };
+    u64 _pending{ 0 };
+    bool _stop{ false };
+};
+
+// Sum of proj(v[i]), the chunk partial sums are added in order, so the result does not depend
+// on the thread count.
+template<typename T, typename Proj>
+f64 parallel_sum(ThreadPool& pool, const std::vector<T>& v, Proj proj);
+
+// Sorts the chunks in parallel, then merges pairs of runs in parallel until one run is left.
+template<typename T, typename Compare>
+void parallel_sort(ThreadPool& pool, std::vector<T>& v, Compare comp);
+
+// Stable partition, returns the number of elements that satisfy `pred`. Every chunk counts its
+// elements, prefix sums give every chunk its output offsets and the elements are scattered once.
+template<typename T, typename Pred>
+u64 parallel_stable_partition(ThreadPool& pool, std::vector<T>& v, Pred pred);
+
+// Removes the elements that satisfy `pred`, the order of the rest is kept.
+template<typename T, typename Pred>
+void parallel_erase_if(ThreadPool& pool, std::vector<T>& v, Pred pred);
+
+//
+
+ThreadPool::ThreadPool(u64 threads) {
+    if (threads == 0) {
+        threads = std::max<u64>(1, std::thread::hardware_concurrency());
+    }
+    _workers.reserve(threads - 1);
+    for (u64 t = 1; t < threads; ++t) {
+        _workers.emplace_back([this]() { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& w : _workers) {
+        w.join();
+    }
+}
+
+void ThreadPool::run(const std::function<void()>& job) {
+    {
+        std::lock_guard lock(_mutex);
+        _job = &job;
+        _pending = _workers.size();
+        ++_generation;
+    }
+    _wake.notify_all();
+
+    job();
+
+    std::unique_lock lock(_mutex);
+    _done.wait(lock, [this]() { return _pending == 0; });
+    _job = nullptr;
+}
+
+void ThreadPool::work() {
+    u64 seen = 0;
+    for (;;) {
+        const std::function<void()>* job = nullptr;
+        {
+            std::unique_lock lock(_mutex);
+            _wake.wait(lock, [&]() { return _stop || _generation != seen; });
+            if (_stop) {
+                return;
+            }
+            seen = _generation;
+            job = _job;
+        }
+
+        (*job)();
+
+        std::lock_guard lock(_mutex);
+        if (--_pending == 0) {
+            _done.notify_one();
+        }
+    }
+}
+
+template<typename F>
+void ThreadPool::parallel_for(u64 begin, u64 end, u64 grain, F f) {
+    if (begin >= end) {
+        return;
+    }
+    grain = std::max<u64>(1, grain);
+    if (_workers.empty() || end - begin <= grain) {
+        f(begin, end);
+        return;
+    }
+
+    std::atomic<u64> next{ begin };
+    run([&]() {
+        for (;;) {
+            const u64 lo = next.fetch_add(grain);
+            if (lo >= end) {
+                return;
+            }
+            f(lo, std::min(end, lo + grain));
+        }
+    });
+}
+
+template<typename T, typename Proj>
+f64 parallel_sum(ThreadPool& pool, const std::vector<T>& v, Proj proj) {
+    const u64 chunks = (v.size() + POOL_GRAIN - 1) / POOL_GRAIN;
+    std::vector<f64> partial(chunks, 0.0);
+
+    pool.parallel_for(0, chunks, 1, [&](u64 lo, u64 hi) {
+        for (u64 c = lo; c < hi; ++c) {
+            f64 sum = 0.0;
+            const u64 end = std::min<u64>(v.size(), (c + 1) * POOL_GRAIN);
+            for (u64 i = c * POOL_GRAIN; i < end; ++i) {
+                sum += static_cast<f64>(std::invoke(proj, v[i]));
+            }
+            partial[c] = sum;
+        }
+    });
+
+    f64 res = 0.0;
+    for (f64 part : partial) {
+        res += part;
+    }
+    return res;
+}
+
+template<typename T, typename Compare>
+void parallel_sort(ThreadPool& pool, std::vector<T>& v, Compare comp) {
+    const u64 size = v.size();
+    const u64 runs = std::min<u64>(pool.get_threads(), std::max<u64>(1, size / POOL_GRAIN));
+    if (runs <= 1) {
+        std::sort(v.begin(), v.end(), comp);
+        return;
+    }
+
+    std::vector<u64> bounds(runs + 1);
+    for (u64 r = 0; r <= runs; ++r) {
+        bounds[r] = size * r / runs;
+    }
+    pool.parallel_for(0, runs, 1, [&](u64 lo, u64 hi) {
+        for (u64 r = lo; r < hi; ++r) {
+            std::sort(v.begin() + bounds[r], v.begin() + bounds[r + 1], comp);
+        }
+    });
+
+    // Merge rounds ping-pong between v and the buffer, every pair of a round merges in parallel.
+    std::vector<T> buffer = v;
+    std::vector<T>* src = &v;
+    std::vector<T>* dst = &buffer;
+    for (; bounds.size() > 2; std::swap(src, dst)) {
+        const u64 pairs = bounds.size() / 2;
+        pool.parallel_for(0, pairs, 1, [&](u64 lo, u64 hi) {
+            for (u64 p = lo; p < hi; ++p) {
+                const u64 first = bounds[2 * p];
+                const u64 mid = bounds[std::min<u64>(2 * p + 1, bounds.size() - 1)];
+                const u64 last = bounds[std::min<u64>(2 * p + 2, bounds.size() - 1)];
+                std::merge(src->begin() + first, src->begin() + mid, src->begin() + mid, src->begin() + last,
+                    dst->begin() + first, comp);
+            }
+        });
+
+        std::vector<u64> merged;
+        for (u64 i = 0; i < bounds.size(); i += 2) {
+            merged.push_back(bounds[i]);
+        }
+        if (merged.back() != size) {
+            merged.push_back(size);
+        }
+        bounds = std::move(merged);
+    }
+
+    if (src != &v) {
+        v = std::move(*src);
+    }
+}
+
+template<typename T, typename Pred>
+u64 parallel_stable_partition(ThreadPool& pool, std::vector<T>& v, Pred pred) {
+    const u64 size = v.size();
+    const u64 chunks = (size + POOL_GRAIN - 1) / POOL_GRAIN;
+    std::vector<u64> count(chunks + 1, 0);
+
+    pool.parallel_for(0, chunks, 1, [&](u64 lo, u64 hi) {
+        for (u64 c = lo; c < hi; ++c) {
+            const u64 end = std::min(size, (c + 1) * POOL_GRAIN);
+            u64 hits = 0;
+            for (u64 i = c * POOL_GRAIN; i < end; ++i) {
+                hits += pred(v[i]) ? 1 : 0;
+            }
+            count[c + 1] = hits;
+        }
+    });
+    for (u64 c = 0; c < chunks; ++c) {
+        count[c + 1] += count[c];
+    }
+    const u64 total = count[chunks];
+
+    std::vector<T> buffer = v;
+    pool.parallel_for(0, chunks, 1, [&](u64 lo, u64 hi) {
+        for (u64 c = lo; c < hi; ++c) {
+            const u64 begin = c * POOL_GRAIN;
+            const u64 end = std::min(size, begin + POOL_GRAIN);
+            u64 yes = count[c];
+            u64 no = total + begin - count[c];
+            for (u64 i = begin; i < end; ++i) {
+                if (pred(v[i])) {
+                    buffer[yes++] = v[i];
+                }
+                else {
+                    buffer[no++] = v[i];
+                }
+            }
+        }
+    });
+
+    v = std::move(buffer);
+    return total;
+}
+
+template<typename T, typename Pred>
+void parallel_erase_if(ThreadPool& pool, std::vector<T>& v, Pred pred) {
+    const u64 kept = parallel_stable_partition(pool, v, [&pred](const T& value) { return !pred(value); });
+    v.erase(v.begin() + kept, v.end());
+}
\ No newline at end of file
@@ -0,0 +1,481 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <numeric>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cassert>
+
+#include "defines.h"
+#include "number.h"
+
+constexpr u64 POOL_LIST_MIN_CHUNK = 64;
+
+// Doubly linked list with the interface of std::list, the nodes are carved out of chunks owned by
+// the list instead of being separate heap blocks. Chunks grow geometrically, erased nodes go on a
+// free list and are reused, reserve() allocates the nodes for a known size in one block.
+template<typename T>
+class PoolList {
+    struct Link {
+        Link* prev;
+        Link* next;
+    };
+    struct Node : Link {
+        union {
+            T value;
+        };
+        Node() {}
+        ~Node() {}
+    };
+    struct Chunk {
+        std::unique_ptr<Node[]> nodes;
+        u64 size;
+    };
+
+    template<bool Const>
+    class Iter {
+        friend class PoolList;
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+    public:
+        Iter() = default;
+        Iter(Link* link) : _link{ link } {}
+        operator Iter<true>() const { return Iter<true>(_link); }
+    public:
+        reference operator*() const { return static_cast<Node*>(_link)->value; }
+        pointer operator->() const { return &static_cast<Node*>(_link)->value; }
+        Iter& operator++() { _link = _link->next; return *this; }
+        Iter operator++(int) { Iter it = *this; _link = _link->next; return it; }
+        Iter& operator--() { _link = _link->prev; return *this; }
+        Iter operator--(int) { Iter it = *this; _link = _link->prev; return it; }
+        bool operator==(const Iter& other) const { return _link == other._link; }
+    private:
+        Link* _link{ nullptr };
+    };
+public:
+    using value_type = T;
+    using iterator = Iter<false>;
+    using const_iterator = Iter<true>;
+public:
+    PoolList();
+    template<typename It>
+    PoolList(It first, It last);
+    PoolList(const PoolList& other);
+    PoolList(PoolList&& other) noexcept;
+    ~PoolList();
+public:
+    PoolList& operator=(const PoolList& other);
+    PoolList& operator=(PoolList&& other) noexcept;
+public:
+    u64 size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    u64 capacity() const { return _capacity; }
+    void reserve(u64 size);
+
+    iterator begin() { return iterator(_head.next); }
+    iterator end() { return iterator(&_head); }
+    const_iterator begin() const { return const_iterator(_head.next); }
+    const_iterator end() const { return const_iterator(const_cast<Link*>(&_head)); }
+
+    T& front() { return *begin(); }
+    T& back() { return *iterator(_head.prev); }
+public:
+    template<typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args);
+    template<typename... Args>
+    T& emplace_back(Args&&... args) { return *emplace(end(), std::forward<Args>(args)...); }
+    void push_back(const T& value) { emplace(end(), value); }
+    void push_front(const T& value) { emplace(begin(), value); }
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+    void clear();
+
+    // Moves all nodes of `other` before `pos`. The chunks of `other` are handed over with them,
+    // so nothing is copied and `other` is left empty.
+    void splice(const_iterator pos, PoolList& other);
+    // Moves [first, last) of this list before `pos` by relinking.
+    void splice(const_iterator pos, const_iterator first, const_iterator last);
+
+    template<typename Pred>
+    u64 remove_if(Pred pred);
+    // Relinks the nodes that satisfy `pred` in front of the others, keeping both orders.
+    // Returns the first node of the second group, no value is moved or copied.
+    template<typename Pred>
+    iterator stable_partition(Pred pred);
+private:
+    Node* allocate();
+    void release(Node* node);
+    void add_chunk(u64 size);
+    static void link_before(Link* pos, Link* link);
+    static void unlink(Link* link);
+    void take(PoolList& other);
+private:
+    Link _head;
+    u64 _size{ 0 };
+    u64 _capacity{ 0 };
+    std::vector<Chunk> _chunks;
+    u64 _used{ 0 };          // nodes handed out from the last chunk
+    Link* _free{ nullptr };  // erased nodes, chained through `next`
+};
+
+// Times the list steps of the lab (building list1 and list2, the mean, the partition, the odd
+// erase and the pairing) with std::list and with PoolList.
+void bench_lists(u64 size);
+
+//
+
+template<typename T>
+PoolList<T>::PoolList() {
+    _head.prev = _head.next = &_head;
+}
+
+template<typename T>
+template<typename It>
+PoolList<T>::PoolList(It first, It last)
+    : PoolList() {
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>) {
+        reserve(static_cast<u64>(std::distance(first, last)));
+    }
+    for (; first != last; ++first) {
+        emplace_back(*first);
+    }
+}
+
+template<typename T>
+PoolList<T>::PoolList(const PoolList& other)
+    : PoolList(other.begin(), other.end()) {}
+
+template<typename T>
+PoolList<T>::PoolList(PoolList&& other) noexcept
+    : PoolList() {
+    take(other);
+}
+
+template<typename T>
+PoolList<T>::~PoolList() {
+    clear();
+}
+
+template<typename T>
+PoolList<T>& PoolList<T>::operator=(const PoolList& other) {
+    if (this != &other) {
+        clear();
+        reserve(other.size());
+        for (const T& value : other) {
+            emplace_back(value);
+        }
+    }
+    return *this;
+}
+
+template<typename T>
+PoolList<T>& PoolList<T>::operator=(PoolList&& other) noexcept {
+    if (this != &other) {
+        clear();
+        _chunks.clear();
+        _capacity = _used = 0;
+        _free = nullptr;
+        take(other);
+    }
+    return *this;
+}
+
+template<typename T>
+void PoolList<T>::take(PoolList& other) {
+    if (!other.empty()) {
+        _head.next = other._head.next;
+        _head.prev = other._head.prev;
+        _head.next->prev = &_head;
+        _head.prev->next = &_head;
+    }
+    _size = other._size;
+    _capacity = other._capacity;
+    _chunks = std::move(other._chunks);
+    _used = other._used;
+    _free = other._free;
+
+    other._head.prev = other._head.next = &other._head;
+    other._size = other._capacity = other._used = 0;
+    other._chunks.clear();
+    other._free = nullptr;
+}
+
+template<typename T>
+void PoolList<T>::add_chunk(u64 size) {
+    _chunks.push_back({ std::make_unique<Node[]>(size), size });
+    _capacity += size;
+    _used = 0;
+}
+
+template<typename T>
+void PoolList<T>::reserve(u64 size) {
+    if (size <= _capacity) {
+        return;
+    }
+    // The nodes left in the current chunk go on the free list before a new chunk replaces it.
+    if (!_chunks.empty()) {
+        Chunk& last = _chunks.back();
+        for (; _used < last.size; ++_used) {
+            release(&last.nodes[_used]);
+        }
+    }
+    add_chunk(size - _capacity);
+}
+
+template<typename T>
+typename PoolList<T>::Node* PoolList<T>::allocate() {
+    if (_free) {
+        Node* node = static_cast<Node*>(_free);
+        _free = _free->next;
+        return node;
+    }
+    if (_chunks.empty() || _used == _chunks.back().size) {
+        add_chunk(std::max(POOL_LIST_MIN_CHUNK, _capacity));
+    }
+    return &_chunks.back().nodes[_used++];
+}
+
+template<typename T>
+void PoolList<T>::release(Node* node) {
+    node->next = _free;
+    _free = node;
+}
+
+template<typename T>
+void PoolList<T>::link_before(Link* pos, Link* link) {
+    link->prev = pos->prev;
+    link->next = pos;
+    pos->prev->next = link;
+    pos->prev = link;
+}
+
+template<typename T>
+void PoolList<T>::unlink(Link* link) {
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+}
+
+template<typename T>
+template<typename... Args>
+typename PoolList<T>::iterator PoolList<T>::emplace(const_iterator pos, Args&&... args) {
+    Node* node = allocate();
+    new (&node->value) T(std::forward<Args>(args)...);
+    link_before(pos._link, node);
+    ++_size;
+    return iterator(node);
+}
+
+template<typename T>
+typename PoolList<T>::iterator PoolList<T>::erase(const_iterator pos) {
+    assert((pos._link != &_head) && "Erasing the end of the list.");
+
+    Link* next = pos._link->next;
+    Node* node = static_cast<Node*>(pos._link);
+    unlink(node);
+    node->value.~T();
+    release(node);
+    --_size;
+    return iterator(next);
+}
+
+template<typename T>
+typename PoolList<T>::iterator PoolList<T>::erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+        first = erase(first);
+    }
+    return iterator(last._link);
+}
+
+template<typename T>
+void PoolList<T>::clear() {
+    erase(begin(), end());
+}
+
+template<typename T>
+void PoolList<T>::splice(const_iterator pos, PoolList& other) {
+    if (&other == this || other.empty()) {
+        return;
+    }
+
+    Link* first = other._head.next;
+    Link* last = other._head.prev;
+    Link* at = pos._link;
+    first->prev = at->prev;
+    last->next = at;
+    at->prev->next = first;
+    at->prev = last;
+    _size += other._size;
+
+    // The spliced nodes still live in the chunks of `other`, those move over too. The nodes
+    // `other` has not handed out yet are freed into this list.
+    if (!other._chunks.empty()) {
+        Chunk& tail = other._chunks.back();
+        for (; other._used < tail.size; ++other._used) {
+            release(&tail.nodes[other._used]);
+        }
+    }
+    while (other._free) {
+        Link* next = other._free->next;
+        release(static_cast<Node*>(other._free));
+        other._free = next;
+    }
+    // Our own partially used chunk stays the last one, so the bump allocation carries on.
+    const u64 at_end = _chunks.empty() ? 0 : 1;
+    _chunks.insert(_chunks.end() - at_end, std::make_move_iterator(other._chunks.begin()), std::make_move_iterator(other._chunks.end()));
+    _capacity += other._capacity;
+    if (at_end == 0) {
+        // Every node of the adopted last chunk is either linked or on the free list.
+        _used = _chunks.back().size;
+    }
+
+    other._head.prev = other._head.next = &other._head;
+    other._size = other._capacity = other._used = 0;
+    other._chunks.clear();
+}
+
+template<typename T>
+void PoolList<T>::splice(const_iterator pos, const_iterator first, const_iterator last) {
+    if (first == last || pos == last) {
+        return;
+    }
+
+    Link* begin = first._link;
+    Link* end = last._link->prev;
+    Link* at = pos._link;
+
+    begin->prev->next = last._link;
+    last._link->prev = begin->prev;
+
+    begin->prev = at->prev;
+    end->next = at;
+    at->prev->next = begin;
+    at->prev = end;
+}
+
+template<typename T>
+template<typename Pred>
+u64 PoolList<T>::remove_if(Pred pred) {
+    u64 removed = 0;
+    for (auto it = begin(); it != end();) {
+        if (pred(*it)) {
+            it = erase(it);
+            ++removed;
+        }
+        else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+template<typename T>
+template<typename Pred>
+typename PoolList<T>::iterator PoolList<T>::stable_partition(Pred pred) {
+    // The rejected nodes are chained on a local sentinel and appended after the walk.
+    Link rest;
+    rest.prev = rest.next = &rest;
+
+    for (Link* link = _head.next; link != &_head;) {
+        Link* next = link->next;
+        if (!pred(static_cast<Node*>(link)->value)) {
+            unlink(link);
+            link_before(&rest, link);
+        }
+        link = next;
+    }
+
+    if (rest.next == &rest) {
+        return end();
+    }
+    Link* first = rest.next;
+    Link* last = rest.prev;
+    first->prev = _head.prev;
+    last->next = &_head;
+    _head.prev->next = first;
+    _head.prev = last;
+    return iterator(first);
+}
+
+template<typename List>
+void run_list_steps(const std::vector<Number>& sorted, u64 n, const char* name) {
+    using clock_t = std::chrono::steady_clock;
+    auto report = [](const char* step, clock_t::time_point start) {
+        std::cout << "    " << step << ": " << std::chrono::duration<f64>(clock_t::now() - start).count() * 1e3 << " ms\n";
+    };
+
+    std::cout << name << ", " << n << " elements per list\n";
+
+    auto start = clock_t::now();
+    List list1(sorted.begin(), sorted.begin() + n);
+    report("build list1", start);
+
+    start = clock_t::now();
+    List list2(sorted.end() - n, sorted.end());
+    report("build list2", start);
+
+    start = clock_t::now();
+    const f64 mean_value = std::accumulate(list1.begin(), list1.end(), 0.0, [](f64 sum, const Number& elem) {
+        return sum + elem.get_i64();
+    }) / static_cast<f64>(n);
+    report("mean", start);
+
+    start = clock_t::now();
+    if constexpr (std::is_same_v<List, std::list<Number>>) {
+        std::stable_partition(list1.begin(), list1.end(), [mean_value](const Number& elem) {
+            return elem.get_i64() > mean_value;
+        });
+    }
+    else {
+        list1.stable_partition([mean_value](const Number& elem) {
+            return elem.get_i64() > mean_value;
+        });
+    }
+    report("partition", start);
+
+    start = clock_t::now();
+    list2.remove_if([](const Number& elem) {
+        return elem.get_i64() % 2 != 0;
+    });
+    report("erase odd", start);
+
+    start = clock_t::now();
+    const u64 min_size = std::min<u64>(list1.size(), list2.size());
+    using Pairs = std::conditional_t<std::is_same_v<List, std::list<Number>>,
+        std::list<std::pair<Number, Number>>, PoolList<std::pair<Number, Number>>>;
+    Pairs list3;
+    if constexpr (!std::is_same_v<List, std::list<Number>>) {
+        list3.reserve(min_size);
+    }
+    auto it1 = list1.begin();
+    auto it2 = list2.begin();
+    for (u64 i = 0; i < min_size; ++i, ++it1, ++it2) {
+        list3.emplace_back(*it1, *it2);
+    }
+    report("pairs", start);
+}
+
+void bench_lists(u64 size) {
+    std::mt19937 mt;
+    std::vector<Number> sorted;
+    sorted.reserve(size);
+    for (u64 i = 0; i < size; ++i) {
+        sorted.emplace_back(mt());
+    }
+    std::sort(sorted.begin(), sorted.end(), std::greater<>());
+
+    const u64 n = size / 20;
+    run_list_steps<std::list<Number>>(sorted, n, "std::list");
+    run_list_steps<PoolList<Number>>(sorted, n, "PoolList");
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <cassert>
+
+#include "defines.h"
+#include "number.h"
+#include "pool.h"
+
+// Slices below this size are not worth a thread of their own.
+constexpr u64 RADIX_MIN_SLICE = 1 << 16;
+
+struct RadixOptions {
+    // 8, 11 or 16. Wider digits mean fewer passes but larger histograms.
+    u64 digit_bits{ 11 };
+    bool descending{ false };
+};
+
+// Key and position of one record. Keys are unsigned, the sign bit of the i64 is flipped so
+// negative values order first.
+struct RadixItem {
+    u64 key;
+    u64 index;
+};
+
+// Stable LSD radix sort of the items by key. Digits that are the same in every key are skipped.
+void radix_sort_items(ThreadPool& pool, std::vector<RadixItem>& items, u64 digit_bits);
+
+// Stable sort of `v` by the i64 `key(v[i])`. Only the 16 byte (key, index) pairs move during the
+// passes, the records themselves are moved once at the end.
+template<typename T, typename Key>
+void radix_sort(ThreadPool& pool, std::vector<T>& v, Key key, const RadixOptions& options = {});
+
+template<typename T, typename Key>
+void radix_sort(std::vector<T>& v, Key key, const RadixOptions& options = {});
+
+// Compares std::sort with the single and multithreaded radix sort on the lab's random Numbers.
+void bench_radix(u64 size, u64 threads = 0);
+
+//
+
+void radix_sort_items(ThreadPool& pool, std::vector<RadixItem>& items, u64 digit_bits) {
+    assert((digit_bits == 8 || digit_bits == 11 || digit_bits == 16) && "Unsupported digit size.");
+
+    const u64 n = items.size();
+    if (n < 2) {
+        return;
+    }
+
+    const u64 radix = 1ull << digit_bits;
+    const u64 mask = radix - 1;
+    const u64 passes = (64 + digit_bits - 1) / digit_bits;
+    const u64 slices = std::min(pool.get_threads(), std::max<u64>(1, n / RADIX_MIN_SLICE));
+
+    std::vector<u64> bounds(slices + 1);
+    for (u64 s = 0; s <= slices; ++s) {
+        bounds[s] = n * s / slices;
+    }
+
+    // Digit totals do not change when the items move, so one read gives the histograms of every
+    // pass. A digit whose bucket holds all n items is the same in every key.
+    std::vector<u64> local(slices * passes * radix, 0);
+    pool.parallel_for(0, slices, 1, [&](u64 lo, u64 hi) {
+        for (u64 s = lo; s < hi; ++s) {
+            u64* hist = local.data() + s * passes * radix;
+            for (u64 i = bounds[s]; i < bounds[s + 1]; ++i) {
+                const u64 k = items[i].key;
+                for (u64 p = 0; p < passes; ++p) {
+                    ++hist[p * radix + ((k >> (p * digit_bits)) & mask)];
+                }
+            }
+        }
+    });
+    std::vector<u64> total(passes * radix, 0);
+    for (u64 s = 0; s < slices; ++s) {
+        for (u64 d = 0; d < passes * radix; ++d) {
+            total[d] += local[s * passes * radix + d];
+        }
+    }
+
+    std::vector<RadixItem> buffer(n);
+    std::vector<RadixItem>* src = &items;
+    std::vector<RadixItem>* dst = &buffer;
+    std::vector<u64> offsets(slices * radix);
+
+    for (u64 p = 0; p < passes; ++p) {
+        const u64 shift = p * digit_bits;
+        const u64* count = total.data() + p * radix;
+        if (count[((*src)[0].key >> shift) & mask] == n) {
+            continue;
+        }
+
+        if (slices == 1) {
+            u64 running = 0;
+            for (u64 d = 0; d < radix; ++d) {
+                offsets[d] = running;
+                running += count[d];
+            }
+        }
+        else {
+            // The items moved since the first read, so every slice counts its digits again.
+            pool.parallel_for(0, slices, 1, [&](u64 lo, u64 hi) {
+                for (u64 s = lo; s < hi; ++s) {
+                    u64* hist = offsets.data() + s * radix;
+                    std::fill(hist, hist + radix, 0);
+                    for (u64 i = bounds[s]; i < bounds[s + 1]; ++i) {
+                        ++hist[((*src)[i].key >> shift) & mask];
+                    }
+                }
+            });
+            // Digit major, slice minor, so every slice writes behind the earlier slices and the
+            // sort stays stable.
+            u64 running = 0;
+            for (u64 d = 0; d < radix; ++d) {
+                for (u64 s = 0; s < slices; ++s) {
+                    const u64 c = offsets[s * radix + d];
+                    offsets[s * radix + d] = running;
+                    running += c;
+                }
+            }
+        }
+
+        pool.parallel_for(0, slices, 1, [&](u64 lo, u64 hi) {
+            for (u64 s = lo; s < hi; ++s) {
+                u64* next = offsets.data() + s * radix;
+                for (u64 i = bounds[s]; i < bounds[s + 1]; ++i) {
+                    const RadixItem& item = (*src)[i];
+                    (*dst)[next[(item.key >> shift) & mask]++] = item;
+                }
+            }
+        });
+        std::swap(src, dst);
+    }
+
+    if (src != &items) {
+        items.swap(buffer);
+    }
+}
+
+template<typename T, typename Key>
+void radix_sort(ThreadPool& pool, std::vector<T>& v, Key key, const RadixOptions& options) {
+    const u64 n = v.size();
+    const u64 flip = options.descending ? ~(1ull << 63) : (1ull << 63);
+
+    std::vector<RadixItem> items(n);
+    pool.parallel_for(0, n, POOL_GRAIN, [&](u64 lo, u64 hi) {
+        for (u64 i = lo; i < hi; ++i) {
+            items[i] = { static_cast<u64>(static_cast<i64>(std::invoke(key, v[i]))) ^ flip, i };
+        }
+    });
+
+    radix_sort_items(pool, items, options.digit_bits);
+
+    std::vector<T> sorted;
+    sorted.reserve(n);
+    for (const RadixItem& item : items) {
+        sorted.push_back(std::move(v[item.index]));
+    }
+    v = std::move(sorted);
+}
+
+template<typename T, typename Key>
+void radix_sort(std::vector<T>& v, Key key, const RadixOptions& options) {
+    ThreadPool pool(1);
+    radix_sort(pool, v, key, options);
+}
+
+void bench_radix(u64 size, u64 threads) {
+    using clock_t = std::chrono::steady_clock;
+
+    std::mt19937 mt;
+    std::vector<Number> numbers;
+    numbers.reserve(size);
+    for (u64 i = 0; i < size; ++i) {
+        numbers.emplace_back(mt());
+    }
+
+    auto by_value = [](const Number& n1, const Number& n2) { return n1.get_i64() < n2.get_i64(); };
+    auto seconds = [](clock_t::time_point start) {
+        return std::chrono::duration<f64>(clock_t::now() - start).count();
+    };
+
+    std::vector<Number> reference = numbers;
+    auto start = clock_t::now();
+    std::sort(reference.begin(), reference.end(), by_value);
+    std::cout << "std::sort, " << size << " elements: " << seconds(start) * 1e3 << " ms\n";
+
+    ThreadPool serial(1);
+    ThreadPool parallel(threads);
+    for (u64 bits : { 8, 11, 16 }) {
+        for (ThreadPool* pool : { &serial, &parallel }) {
+            std::vector<Number> sorted = numbers;
+            start = clock_t::now();
+            radix_sort(*pool, sorted, &Number::get_i64, { bits });
+            const f64 time = seconds(start);
+
+            std::cout << "radix " << bits << " bit digits, " << pool->get_threads() << " threads: " << time * 1e3
+                << " ms, same result: " << (sorted == reference) << "\n";
+        }
+    }
+}
\ No newline at end of file
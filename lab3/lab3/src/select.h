@@ -0,0 +1,164 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <istream>
+
+#include "defines.h"
+#include "number.h"
+
+// Keeps the k best values pushed so far, `Better` orders the projected keys best first.
+// The root of the heap is the worst kept value, so a push costs O(log k) and memory stays O(k).
+template<typename T, typename Better, typename Proj = std::identity>
+class BoundedHeap {
+public:
+    BoundedHeap(u64 k, Better better = {}, Proj proj = {});
+public:
+    u64 get_size() const { return _heap.size(); }
+    u64 get_capacity() const { return _k; }
+
+    void push(const T& value);
+    // Kept values, best first. The heap is left empty.
+    std::vector<T> take();
+private:
+    bool better(const T& v1, const T& v2) const {
+        return std::invoke(_better, std::invoke(_proj, v1), std::invoke(_proj, v2));
+    }
+private:
+    u64 _k{ 0 };
+    Better _better;
+    Proj _proj;
+    std::vector<T> _heap;
+};
+
+// The k largest / smallest values of a range or of an input iterator pair, best first.
+// The input is read once and never copied, O(n log k) time and O(k) memory.
+template<typename It, typename Proj = std::identity>
+std::vector<std::iter_value_t<It>> top_k(It first, It last, u64 k, Proj proj = {});
+
+template<typename It, typename Proj = std::identity>
+std::vector<std::iter_value_t<It>> bottom_k(It first, It last, u64 k, Proj proj = {});
+
+template<std::ranges::range Range, typename Proj = std::identity>
+auto top_k(const Range& range, u64 k, Proj proj = {});
+
+template<std::ranges::range Range, typename Proj = std::identity>
+auto bottom_k(const Range& range, u64 k, Proj proj = {});
+
+// Numbers read as i64 values up to the end of the stream.
+std::vector<Number> top_k(std::istream& in, u64 k);
+std::vector<Number> bottom_k(std::istream& in, u64 k);
+
+// In place selection for a range the caller may reorder: moves the k largest / smallest values
+// to the front, sorted best first, and returns the end of them. At most O(n log k), nothing is copied.
+template<typename It, typename Proj = std::identity>
+It select_top_k(It first, It last, u64 k, Proj proj = {});
+
+template<typename It, typename Proj = std::identity>
+It select_bottom_k(It first, It last, u64 k, Proj proj = {});
+
+//
+
+template<typename T, typename Better, typename Proj>
+BoundedHeap<T, Better, Proj>::BoundedHeap(u64 k, Better better, Proj proj)
+    : _k{ k }, _better{ better }, _proj{ proj } {
+    _heap.reserve(k);
+}
+
+template<typename T, typename Better, typename Proj>
+void BoundedHeap<T, Better, Proj>::push(const T& value) {
+    // With `better` as the heap order the front is the worst kept value.
+    auto order = [this](const T& v1, const T& v2) { return better(v1, v2); };
+
+    if (_heap.size() < _k) {
+        _heap.push_back(value);
+        std::push_heap(_heap.begin(), _heap.end(), order);
+    }
+    else if (_k > 0 && better(value, _heap.front())) {
+        std::pop_heap(_heap.begin(), _heap.end(), order);
+        _heap.back() = value;
+        std::push_heap(_heap.begin(), _heap.end(), order);
+    }
+}
+
+template<typename T, typename Better, typename Proj>
+std::vector<T> BoundedHeap<T, Better, Proj>::take() {
+    std::sort_heap(_heap.begin(), _heap.end(), [this](const T& v1, const T& v2) { return better(v1, v2); });
+    return std::move(_heap);
+}
+
+template<typename It, typename Proj>
+std::vector<std::iter_value_t<It>> top_k(It first, It last, u64 k, Proj proj) {
+    BoundedHeap<std::iter_value_t<It>, std::greater<>, Proj> heap(k, {}, proj);
+    for (; first != last; ++first) {
+        heap.push(*first);
+    }
+    return heap.take();
+}
+
+template<typename It, typename Proj>
+std::vector<std::iter_value_t<It>> bottom_k(It first, It last, u64 k, Proj proj) {
+    BoundedHeap<std::iter_value_t<It>, std::less<>, Proj> heap(k, {}, proj);
+    for (; first != last; ++first) {
+        heap.push(*first);
+    }
+    return heap.take();
+}
+
+template<std::ranges::range Range, typename Proj>
+auto top_k(const Range& range, u64 k, Proj proj) {
+    return top_k(std::begin(range), std::end(range), k, proj);
+}
+
+template<std::ranges::range Range, typename Proj>
+auto bottom_k(const Range& range, u64 k, Proj proj) {
+    return bottom_k(std::begin(range), std::end(range), k, proj);
+}
+
+std::vector<Number> top_k(std::istream& in, u64 k) {
+    BoundedHeap<Number, std::greater<>> heap(k);
+    for (i64 value; in >> value;) {
+        heap.push(Number(value));
+    }
+    return heap.take();
+}
+
+std::vector<Number> bottom_k(std::istream& in, u64 k) {
+    BoundedHeap<Number, std::less<>> heap(k);
+    for (i64 value; in >> value;) {
+        heap.push(Number(value));
+    }
+    return heap.take();
+}
+
+template<typename It, typename Better, typename Proj>
+It select_k(It first, It last, u64 k, Better better, Proj proj) {
+    auto order = [&](const auto& v1, const auto& v2) {
+        return better(std::invoke(proj, v1), std::invoke(proj, v2));
+    };
+
+    const u64 size = static_cast<u64>(std::distance(first, last));
+    It mid = first + std::min(k, size);
+    // A small k is cheaper with partial_sort, a large one with a linear nth_element first.
+    if (k * 16 < size) {
+        std::partial_sort(first, mid, last, order);
+    }
+    else {
+        std::nth_element(first, mid, last, order);
+        std::sort(first, mid, order);
+    }
+    return mid;
+}
+
+template<typename It, typename Proj>
+It select_top_k(It first, It last, u64 k, Proj proj) {
+    return select_k(first, last, k, std::greater<>(), proj);
+}
+
+template<typename It, typename Proj>
+It select_bottom_k(It first, It last, u64 k, Proj proj) {
+    return select_k(first, last, k, std::less<>(), proj);
+}
\ No newline at end of file
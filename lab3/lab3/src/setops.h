@@ -0,0 +1,148 @@
+#pragma once
+
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <iterator>
+
+#include "defines.h"
+#include "number.h"
+
+// Key sets up to this size are kept as a sorted array, past it a hash set wins over binary search.
+constexpr u64 SET_SORT_LIMIT = 1 << 16;
+
+enum class SetStrategy : u32 {
+    AUTO = 0,
+    HASH = 1,
+    SORT = 2,
+};
+
+// Values of the Numbers in `keys`, looked up either by hash or by binary search in a sorted array.
+class KeySet {
+public:
+    template<typename Range>
+    KeySet(const Range& keys, SetStrategy strategy = SetStrategy::AUTO);
+public:
+    bool contains(i64 key) const;
+    bool contains(const Number& number) const { return contains(number.get_i64()); }
+    bool is_sorted() const { return _strategy == SetStrategy::SORT; }
+    // Sorted and deduplicated keys, only filled by the SORT strategy.
+    const std::vector<i64>& get_sorted() const { return _sorted; }
+private:
+    SetStrategy _strategy;
+    std::vector<i64> _sorted;
+    std::unordered_set<i64> _hashed;
+};
+
+// Elements of `v` that are also in `keys`, in the order of `v`, duplicates of `v` are kept.
+template<typename Range>
+std::vector<Number> intersection(const std::vector<Number>& v, const Range& keys, SetStrategy strategy = SetStrategy::AUTO);
+
+// Elements of `v` that are not in `keys`, in the order of `v`.
+template<typename Range>
+std::vector<Number> difference(const std::vector<Number>& v, const Range& keys, SetStrategy strategy = SetStrategy::AUTO);
+
+// Removes every element of `v` that is in `keys` in a single pass, the order of the rest is kept.
+template<typename Container, typename Range>
+void erase_keys(Container& v, const Range& keys, SetStrategy strategy = SetStrategy::AUTO);
+
+//
+
+template<typename Range>
+KeySet::KeySet(const Range& keys, SetStrategy strategy) {
+    const u64 size = static_cast<u64>(std::distance(std::begin(keys), std::end(keys)));
+    if (strategy == SetStrategy::AUTO) {
+        strategy = size <= SET_SORT_LIMIT ? SetStrategy::SORT : SetStrategy::HASH;
+    }
+    _strategy = strategy;
+
+    if (_strategy == SetStrategy::SORT) {
+        _sorted.reserve(size);
+        for (const Number& key : keys) {
+            _sorted.push_back(key.get_i64());
+        }
+        std::sort(_sorted.begin(), _sorted.end());
+        _sorted.erase(std::unique(_sorted.begin(), _sorted.end()), _sorted.end());
+    }
+    else {
+        _hashed.reserve(size);
+        for (const Number& key : keys) {
+            _hashed.insert(key.get_i64());
+        }
+    }
+}
+
+bool KeySet::contains(i64 key) const {
+    if (_strategy == SetStrategy::SORT) {
+        return std::binary_search(_sorted.begin(), _sorted.end(), key);
+    }
+    return _hashed.contains(key);
+}
+
+// Calls keep(number, in_keys) for every element of `v`. A `v` sorted in either direction is
+// merged against the sorted keys in one linear walk, anything else probes the key set.
+template<typename Container, typename F>
+void for_each_membership(const Container& v, const KeySet& set, F keep) {
+    if (set.is_sorted()) {
+        const auto& keys = set.get_sorted();
+        auto ascending = [](const Number& n1, const Number& n2) { return n1.get_i64() < n2.get_i64(); };
+        auto descending = [](const Number& n1, const Number& n2) { return n1.get_i64() > n2.get_i64(); };
+        if (std::is_sorted(v.begin(), v.end(), ascending)) {
+            auto k = keys.begin();
+            for (const Number& number : v) {
+                while (k != keys.end() && *k < number.get_i64()) {
+                    ++k;
+                }
+                keep(number, k != keys.end() && *k == number.get_i64());
+            }
+            return;
+        }
+        if (std::is_sorted(v.begin(), v.end(), descending)) {
+            auto k = keys.rbegin();
+            for (const Number& number : v) {
+                while (k != keys.rend() && *k > number.get_i64()) {
+                    ++k;
+                }
+                keep(number, k != keys.rend() && *k == number.get_i64());
+            }
+            return;
+        }
+    }
+
+    for (const Number& number : v) {
+        keep(number, set.contains(number));
+    }
+}
+
+template<typename Range>
+std::vector<Number> intersection(const std::vector<Number>& v, const Range& keys, SetStrategy strategy) {
+    const KeySet set(keys, strategy);
+    std::vector<Number> res;
+    for_each_membership(v, set, [&res](const Number& number, bool in_keys) {
+        if (in_keys) {
+            res.push_back(number);
+        }
+    });
+    return res;
+}
+
+template<typename Range>
+std::vector<Number> difference(const std::vector<Number>& v, const Range& keys, SetStrategy strategy) {
+    const KeySet set(keys, strategy);
+    std::vector<Number> res;
+    res.reserve(v.size());
+    for_each_membership(v, set, [&res](const Number& number, bool in_keys) {
+        if (!in_keys) {
+            res.push_back(number);
+        }
+    });
+    return res;
+}
+
+template<typename Container, typename Range>
+void erase_keys(Container& v, const Range& keys, SetStrategy strategy) {
+    const KeySet set(keys, strategy);
+    v.erase(std::remove_if(v.begin(), v.end(), [&set](const Number& number) {
+        return set.contains(number);
+    }), v.end());
+}
\ No newline at end of file
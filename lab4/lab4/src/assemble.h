@@ -0,0 +1,235 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <unordered_map>
+#include <cassert>
+
+#include "defines.h"
+#include "mat.h"
+#include "csr.h"
+
+using MatList = std::vector<std::reference_wrapper<const Mat>>;
+using CsrList = std::vector<std::reference_wrapper<const Csr>>;
+// Grid of blocks, nullptr stands for a zero block. Every block row and every block column
+// needs at least one block to fix its size.
+using BlockGrid = std::vector<std::vector<const Mat*>>;
+using CsrBlockGrid = std::vector<std::vector<const Csr*>>;
+
+// Kronecker product, the (i, j) block of the result is a(i, j) * b.
+Csr kron(const Csr& a, const Csr& b);
+Mat kron(const Mat& a, const Mat& b);
+
+Csr block(const CsrBlockGrid& grid);
+Mat block(const BlockGrid& grid);
+
+Mat hstack(const MatList& mats);
+Mat vstack(const MatList& mats);
+// Built without a block grid, in O(nnz + rows) for any number of blocks.
+Csr block_diag(const CsrList& mats);
+Mat block_diag(const MatList& mats);
+
+//
+
+Csr kron(const Csr& a, const Csr& b) {
+    Csr res;
+    res.rows = a.rows * b.rows;
+    res.cols = a.cols * b.cols;
+    res.row_ptr.resize(res.rows + 1);
+    res.col_idx.resize(a.get_nnz() * b.get_nnz());
+    res.values.resize(a.get_nnz() * b.get_nnz());
+
+    // Row (ia, ib) holds every pair of entries of row ia of a and row ib of b, walking
+    // both in column order gives the output columns ja * b.cols + jb in order too.
+    u64 pos = 0;
+    for (u64 ia = 0; ia < a.rows; ++ia) {
+        for (u64 ib = 0; ib < b.rows; ++ib) {
+            res.row_ptr[ia * b.rows + ib] = pos;
+            for (u64 k = a.row_ptr[ia]; k < a.row_ptr[ia + 1]; ++k) {
+                const u64 offset = a.col_idx[k] * b.cols;
+                const f64 value = a.values[k];
+                for (u64 l = b.row_ptr[ib]; l < b.row_ptr[ib + 1]; ++l) {
+                    res.col_idx[pos] = offset + b.col_idx[l];
+                    res.values[pos] = value * b.values[l];
+                    ++pos;
+                }
+            }
+        }
+    }
+    res.row_ptr[res.rows] = pos;
+
+    return res;
+}
+
+Mat kron(const Mat& a, const Mat& b) {
+    return kron(Csr(a), Csr(b)).to_mat();
+}
+
+Csr block(const CsrBlockGrid& grid) {
+    assert(!grid.empty() && "Empty block grid.");
+
+    const u64 block_rows = grid.size();
+    const u64 block_cols = grid.front().size();
+
+    std::vector<u64> heights(block_rows, 0);
+    std::vector<u64> widths(block_cols, 0);
+    std::vector<bool> height_set(block_rows, false);
+    std::vector<bool> width_set(block_cols, false);
+    u64 nnz = 0;
+
+    for (u64 bi = 0; bi < block_rows; ++bi) {
+        assert((grid[bi].size() == block_cols) && "Invalid block column count.");
+        for (u64 bj = 0; bj < block_cols; ++bj) {
+            const Csr* b = grid[bi][bj];
+            if (!b) {
+                continue;
+            }
+            assert((!height_set[bi] || heights[bi] == b->rows) && "Blocks of one block row differ in height.");
+            assert((!width_set[bj] || widths[bj] == b->cols) && "Blocks of one block column differ in width.");
+            heights[bi] = b->rows;
+            widths[bj] = b->cols;
+            height_set[bi] = width_set[bj] = true;
+            nnz += b->get_nnz();
+        }
+    }
+    assert((std::all_of(height_set.begin(), height_set.end(), [](bool set) { return set; })
+        && std::all_of(width_set.begin(), width_set.end(), [](bool set) { return set; }))
+        && "Every block row and column needs a block.");
+
+    std::vector<u64> col_offset(block_cols + 1, 0);
+    for (u64 bj = 0; bj < block_cols; ++bj) {
+        col_offset[bj + 1] = col_offset[bj] + widths[bj];
+    }
+
+    Csr res;
+    res.cols = col_offset.back();
+    for (u64 h : heights) {
+        res.rows += h;
+    }
+    res.row_ptr.resize(res.rows + 1);
+    res.col_idx.resize(nnz);
+    res.values.resize(nnz);
+
+    // Blocks of a block row are visited left to right, so the columns come out sorted.
+    u64 row = 0;
+    u64 pos = 0;
+    for (u64 bi = 0; bi < block_rows; ++bi) {
+        for (u64 r = 0; r < heights[bi]; ++r, ++row) {
+            res.row_ptr[row] = pos;
+            for (u64 bj = 0; bj < block_cols; ++bj) {
+                const Csr* b = grid[bi][bj];
+                if (!b) {
+                    continue;
+                }
+                for (u64 k = b->row_ptr[r]; k < b->row_ptr[r + 1]; ++k) {
+                    res.col_idx[pos] = col_offset[bj] + b->col_idx[k];
+                    res.values[pos] = b->values[k];
+                    ++pos;
+                }
+            }
+        }
+    }
+    res.row_ptr[res.rows] = pos;
+
+    return res;
+}
+
+// Every distinct Mat is converted once, even when it is repeated. The returned index is the
+// position of the conversion of m in `converted`.
+u64 convert_once(const Mat* m, std::unordered_map<const Mat*, u64>& indices, std::vector<Csr>& converted) {
+    const auto [it, inserted] = indices.emplace(m, converted.size());
+    if (inserted) {
+        converted.emplace_back(*m);
+    }
+    return it->second;
+}
+
+Mat block(const BlockGrid& grid) {
+    std::unordered_map<const Mat*, u64> indices;
+    std::vector<u64> grid_indices;
+    std::vector<Csr> converted;
+    for (const auto& row : grid) {
+        for (const Mat* m : row) {
+            if (m) {
+                grid_indices.push_back(convert_once(m, indices, converted));
+            }
+        }
+    }
+
+    // The pointers are taken after the last conversion, `converted` does not move any more.
+    CsrBlockGrid csr_grid(grid.size());
+    u64 next = 0;
+    for (u64 bi = 0; bi < grid.size(); ++bi) {
+        for (const Mat* m : grid[bi]) {
+            csr_grid[bi].push_back(m ? &converted[grid_indices[next++]] : nullptr);
+        }
+    }
+
+    return block(csr_grid).to_mat();
+}
+
+Mat hstack(const MatList& mats) {
+    BlockGrid grid(1);
+    for (const Mat& m : mats) {
+        grid[0].push_back(&m);
+    }
+    return block(grid);
+}
+
+Mat vstack(const MatList& mats) {
+    BlockGrid grid;
+    for (const Mat& m : mats) {
+        grid.push_back({ &m });
+    }
+    return block(grid);
+}
+
+Csr block_diag(const CsrList& mats) {
+    Csr res;
+    u64 nnz = 0;
+    for (const Csr& m : mats) {
+        res.rows += m.rows;
+        res.cols += m.cols;
+        nnz += m.get_nnz();
+    }
+    res.row_ptr.resize(res.rows + 1);
+    res.col_idx.resize(nnz);
+    res.values.resize(nnz);
+
+    // Block i starts at the running row and column offsets of the blocks before it.
+    u64 row = 0;
+    u64 col = 0;
+    u64 pos = 0;
+    for (const Csr& m : mats) {
+        for (u64 r = 0; r < m.rows; ++r, ++row) {
+            res.row_ptr[row] = pos;
+            for (u64 k = m.row_ptr[r]; k < m.row_ptr[r + 1]; ++k) {
+                res.col_idx[pos] = col + m.col_idx[k];
+                res.values[pos] = m.values[k];
+                ++pos;
+            }
+        }
+        col += m.cols;
+    }
+    res.row_ptr[res.rows] = pos;
+
+    return res;
+}
+
+Mat block_diag(const MatList& mats) {
+    std::unordered_map<const Mat*, u64> indices;
+    std::vector<u64> list_indices;
+    std::vector<Csr> converted;
+    list_indices.reserve(mats.size());
+    for (const Mat& m : mats) {
+        list_indices.push_back(convert_once(&m, indices, converted));
+    }
+
+    CsrList csr_mats;
+    csr_mats.reserve(mats.size());
+    for (u64 idx : list_indices) {
+        csr_mats.push_back(std::cref(converted[idx]));
+    }
+
+    return block_diag(csr_mats).to_mat();
+}
\ No newline at end of file
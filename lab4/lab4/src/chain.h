@@ -0,0 +1,221 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <functional>
+#include <limits>
+#include <cmath>
+#include <cassert>
+
+#include "defines.h"
+#include "mat.h"
+
+using MatChain = std::vector<std::reference_wrapper<const Mat>>;
+
+// Estimated shape of a (partial) product.
+struct MatShape {
+    u64 rows{ 0 };
+    u64 cols{ 0 };
+    f64 nnz{ 0.0 };
+};
+
+// Order of evaluation for A1 * A2 * ... * An chosen by dynamic programming.
+class ChainPlan {
+public:
+    ChainPlan(u64 count);
+public:
+    u64 get_count() const { return _count; }
+    // Index k of the last split of the sub chain [i..j]: (Ai..Ak) * (Ak+1..Aj).
+    u64 get_split(u64 i, u64 j) const { return _split[i * _count + j]; }
+    f64 get_cost(u64 i, u64 j) const { return _cost[i * _count + j]; }
+    const MatShape& get_shape(u64 i, u64 j) const { return _shape[i * _count + j]; }
+    f64 get_estimated_flops() const { return get_cost(0, _count - 1); }
+    std::string to_string() const;
+private:
+    void write(std::string& out, u64 i, u64 j) const;
+private:
+    friend ChainPlan plan_chain(const MatChain& chain);
+
+    u64 _count{ 0 };
+    std::vector<u64> _split;
+    std::vector<f64> _cost;
+    std::vector<MatShape> _shape;
+};
+
+struct ChainReport {
+    f64 estimated_flops{ 0.0 };
+    u64 actual_flops{ 0 };
+};
+
+MatShape estimate_product_shape(const MatShape& a, const MatShape& b);
+
+f64 estimate_product_flops(const MatShape& a, const MatShape& b);
+
+u64 count_product_flops(const Mat& a, const Mat& b);
+
+ChainPlan plan_chain(const MatChain& chain);
+
+Mat chain_product(const MatChain& chain, const ChainPlan& plan, ChainReport* report = nullptr);
+
+Mat chain_product(const MatChain& chain, ChainReport* report = nullptr);
+
+//
+
+ChainPlan::ChainPlan(u64 count)
+    : _count{ count },
+    _split(count * count, 0),
+    _cost(count * count, 0.0),
+    _shape(count * count) {}
+
+std::string ChainPlan::to_string() const {
+    std::string out;
+    if (_count != 0) {
+        write(out, 0, _count - 1);
+    }
+    return out;
+}
+
+void ChainPlan::write(std::string& out, u64 i, u64 j) const {
+    if (i == j) {
+        out += "A" + std::to_string(i + 1);
+        return;
+    }
+
+    u64 k = get_split(i, j);
+
+    out += "(";
+    write(out, i, k);
+    out += " ";
+    write(out, k + 1, j);
+    out += ")";
+}
+
+// Assumes the non zeros are spread uniformly: a cell of the product is
+// non zero unless all of its `inner` candidate terms are zero.
+MatShape estimate_product_shape(const MatShape& a, const MatShape& b) {
+    assert(a.cols == b.rows && "Invalid matrices.");
+
+    MatShape res{ a.rows, b.cols, 0.0 };
+
+    if (a.cols == 0 || a.rows == 0 || b.cols == 0) {
+        return res;
+    }
+
+    f64 cells = static_cast<f64>(a.rows) * static_cast<f64>(b.cols);
+    f64 density_a = a.nnz / (static_cast<f64>(a.rows) * static_cast<f64>(a.cols));
+    f64 density_b = b.nnz / (static_cast<f64>(b.rows) * static_cast<f64>(b.cols));
+    f64 term = std::min(1.0, density_a * density_b);
+
+    f64 fill = term < 1.0
+        ? -std::expm1(static_cast<f64>(a.cols) * std::log1p(-term))
+        : 1.0;
+
+    res.nnz = std::min(cells, cells * fill);
+    return res;
+}
+
+// Every value a(i, k) is multiplied with the values of row k of b, nnz(b) / rows(b) on average.
+f64 estimate_product_flops(const MatShape& a, const MatShape& b) {
+    assert(a.cols == b.rows && "Invalid matrices.");
+
+    if (b.rows == 0) {
+        return 0.0;
+    }
+    return a.nnz * b.nnz / static_cast<f64>(b.rows);
+}
+
+u64 count_product_flops(const Mat& a, const Mat& b) {
+    assert(a.get_cols() == b.get_rows() && "Invalid matrices.");
+
+    std::vector<u64> col_count(a.get_cols(), 0);
+    for (const auto& [idx, value] : a) {
+        ++col_count[idx.second];
+    }
+
+    u64 flops = 0;
+    for (const auto& [idx, value] : b) {
+        flops += col_count[idx.first];
+    }
+    return flops;
+}
+
+ChainPlan plan_chain(const MatChain& chain) {
+    assert(!chain.empty() && "The chain must contain at least one matrix.");
+
+    const u64 count = chain.size();
+    ChainPlan plan(count);
+
+    for (u64 i = 0; i < count; ++i) {
+        const Mat& m = chain[i].get();
+        if (i + 1 < count) {
+            assert(m.get_cols() == chain[i + 1].get().get_rows() && "Invalid matrices.");
+        }
+        plan._shape[i * count + i] = { m.get_rows(), m.get_cols(), static_cast<f64>(m.get_nnz()) };
+    }
+
+    for (u64 len = 2; len <= count; ++len) {
+        for (u64 i = 0; i + len <= count; ++i) {
+            u64 j = i + len - 1;
+
+            f64 best_cost = std::numeric_limits<f64>::infinity();
+            u64 best_split = i;
+            MatShape best_shape;
+
+            for (u64 k = i; k < j; ++k) {
+                const MatShape& left = plan.get_shape(i, k);
+                const MatShape& right = plan.get_shape(k + 1, j);
+
+                f64 cost = plan.get_cost(i, k) + plan.get_cost(k + 1, j) + estimate_product_flops(left, right);
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_split = k;
+                    best_shape = estimate_product_shape(left, right);
+                }
+            }
+
+            plan._cost[i * count + j] = best_cost;
+            plan._split[i * count + j] = best_split;
+            plan._shape[i * count + j] = best_shape;
+        }
+    }
+
+    return plan;
+}
+
+Mat chain_multiply(const MatChain& chain, const ChainPlan& plan, u64 i, u64 j, u64& flops) {
+    assert(i < j && "Sub chain must contain at least two matrices.");
+
+    u64 k = plan.get_split(i, j);
+
+    Mat left_storage(0, 0);
+    Mat right_storage(0, 0);
+    if (i != k) {
+        left_storage = chain_multiply(chain, plan, i, k, flops);
+    }
+    if (k + 1 != j) {
+        right_storage = chain_multiply(chain, plan, k + 1, j, flops);
+    }
+
+    const Mat& left = i == k ? chain[i].get() : left_storage;
+    const Mat& right = k + 1 == j ? chain[j].get() : right_storage;
+
+    flops += count_product_flops(left, right);
+    return left * right;
+}
+
+Mat chain_product(const MatChain& chain, const ChainPlan& plan, ChainReport* report) {
+    assert(plan.get_count() == chain.size() && "The plan was built for another chain.");
+
+    u64 flops = 0;
+    Mat res = chain.size() == 1 ? chain.front().get() : chain_multiply(chain, plan, 0, chain.size() - 1, flops);
+
+    if (report) {
+        report->estimated_flops = plan.get_estimated_flops();
+        report->actual_flops = flops;
+    }
+
+    return res;
+}
+
+Mat chain_product(const MatChain& chain, ChainReport* report) {
+    return chain_product(chain, plan_chain(chain), report);
+}
\ No newline at end of file
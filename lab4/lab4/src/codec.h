@@ -0,0 +1,422 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+
+#include "defines.h"
+#include "vec.h"
+#include "mat.h"
+
+// Binary layout, all fixed width fields are little endian:
+//   magic  u32     CODEC_VEC_MAGIC or CODEC_MAT_MAGIC
+//   flags  u8      CODEC_F32_VALUES
+//   shape  varint  size for Vec, rows and cols for Mat
+//   nnz    varint
+// followed by blocks of CODEC_BLOCK_SIZE entries (the last one may be shorter):
+//   indices  varint gaps, idx - (previous idx + 1), the first gap is taken from 0
+//   values   raw f64, or f32 if CODEC_F32_VALUES is set
+// Matrix entries are indexed by row * cols + col, so the order is row major.
+
+constexpr std::uint32_t CODEC_VEC_MAGIC = 0x31565053; // "SPV1"
+constexpr std::uint32_t CODEC_MAT_MAGIC = 0x314D5053; // "SPM1"
+constexpr u8 CODEC_F32_VALUES = 1;
+constexpr u64 CODEC_BLOCK_SIZE = 4096;
+constexpr u64 CODEC_BUFFER_SIZE = 1 << 16;
+constexpr u64 CODEC_MAX_VARINT_SIZE = 10;
+
+struct CodecOptions {
+    bool f32_values{ false };
+};
+
+struct CodecHeader {
+    std::uint32_t magic{ 0 }; // u32 is unsigned long, which is 8 bytes outside of Windows
+    u8 flags{ 0 };
+    u64 rows{ 0 };
+    u64 cols{ 1 };
+    u64 nnz{ 0 };
+};
+
+// Streams (index, value) pairs with strictly increasing indices into `out`.
+class SparseEncoder {
+public:
+    SparseEncoder(std::ostream& out, const CodecHeader& header);
+public:
+    void push(u64 idx, f64 value);
+    bool finish();
+private:
+    void write_block();
+    void write_varint(u64 value);
+    void write_bytes(const void* data, u64 size);
+    void reserve(u64 size);
+    void flush();
+private:
+    std::ostream& _out;
+    CodecHeader _header;
+    std::vector<char> _buffer;
+    u64 _pos{ 0 };
+    std::vector<u64> _indices;
+    std::vector<f64> _values;
+    std::vector<f32> _narrow;
+    u64 _next_idx{ 0 };
+    u64 _pushed{ 0 };
+};
+
+// Reads back what SparseEncoder wrote, one block of entries at a time.
+class SparseDecoder {
+public:
+    SparseDecoder(std::istream& in);
+public:
+    const CodecHeader& get_header() const { return _header; }
+    bool good() const { return _good; }
+    bool next(u64& idx, f64& value);
+private:
+    bool read_block();
+    bool read_varint(u64& value);
+    bool read_bytes(void* data, u64 size);
+    bool fill(u64 size);
+private:
+    std::istream& _in;
+    CodecHeader _header;
+    bool _good{ true };
+    std::vector<char> _buffer;
+    u64 _pos{ 0 };
+    u64 _end{ 0 };
+    std::vector<u64> _indices;
+    std::vector<f64> _values;
+    std::vector<f32> _narrow;
+    u64 _block_pos{ 0 };
+    u64 _decoded{ 0 };
+    u64 _next_idx{ 0 };
+};
+
+bool encode(std::ostream& out, const Vec& vec, const CodecOptions& options = {});
+
+bool encode(std::ostream& out, const Mat& mat, const CodecOptions& options = {});
+
+bool decode(std::istream& in, Vec& vec);
+
+bool decode(std::istream& in, Mat& mat);
+
+//
+
+SparseEncoder::SparseEncoder(std::ostream& out, const CodecHeader& header)
+    : _out{ out }, _header{ header }, _buffer(CODEC_BUFFER_SIZE) {
+    assert((header.magic == CODEC_VEC_MAGIC || header.magic == CODEC_MAT_MAGIC) && "Unknown magic.");
+    assert((header.rows == 0 || header.cols <= std::numeric_limits<u64>::max() / header.rows) && "Too many cells.");
+    assert((header.nnz <= header.rows * header.cols) && "Too many values.");
+
+    _indices.reserve(CODEC_BLOCK_SIZE);
+    _values.reserve(CODEC_BLOCK_SIZE);
+
+    write_bytes(&_header.magic, sizeof(_header.magic));
+    write_bytes(&_header.flags, sizeof(_header.flags));
+    write_varint(_header.rows);
+    if (_header.magic == CODEC_MAT_MAGIC) {
+        write_varint(_header.cols);
+    }
+    write_varint(_header.nnz);
+}
+
+void SparseEncoder::push(u64 idx, f64 value) {
+    assert((_pushed < _header.nnz) && "More values than announced in the header.");
+    assert((_next_idx <= idx && idx < _header.rows * _header.cols) && "Indices must be increasing and in range.");
+
+    _indices.push_back(idx);
+    _values.push_back(value);
+    ++_pushed;
+
+    if (_indices.size() == CODEC_BLOCK_SIZE) {
+        write_block();
+    }
+}
+
+bool SparseEncoder::finish() {
+    assert((_pushed == _header.nnz) && "Less values than announced in the header.");
+
+    if (!_indices.empty()) {
+        write_block();
+    }
+    flush();
+    _out.flush();
+
+    return _out.good();
+}
+
+void SparseEncoder::write_block() {
+    for (u64 idx : _indices) {
+        write_varint(idx - _next_idx);
+        _next_idx = idx + 1;
+    }
+
+    if (_header.flags & CODEC_F32_VALUES) {
+        _narrow.resize(_values.size());
+        std::transform(_values.begin(), _values.end(), _narrow.begin(), [](f64 value) {
+            return static_cast<f32>(value);
+        });
+        write_bytes(_narrow.data(), _narrow.size() * sizeof(f32));
+    }
+    else {
+        write_bytes(_values.data(), _values.size() * sizeof(f64));
+    }
+
+    _indices.clear();
+    _values.clear();
+}
+
+void SparseEncoder::write_varint(u64 value) {
+    reserve(CODEC_MAX_VARINT_SIZE);
+
+    while (value >= 0x80) {
+        _buffer[_pos++] = static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    _buffer[_pos++] = static_cast<char>(value);
+}
+
+void SparseEncoder::write_bytes(const void* data, u64 size) {
+    const char* bytes = static_cast<const char*>(data);
+
+    while (size != 0) {
+        if (_pos == _buffer.size()) {
+            flush();
+        }
+        u64 chunk = std::min(size, _buffer.size() - _pos);
+        std::memcpy(_buffer.data() + _pos, bytes, chunk);
+
+        _pos += chunk;
+        bytes += chunk;
+        size -= chunk;
+    }
+}
+
+void SparseEncoder::reserve(u64 size) {
+    if (_buffer.size() - _pos < size) {
+        flush();
+    }
+}
+
+void SparseEncoder::flush() {
+    _out.write(_buffer.data(), _pos);
+    _pos = 0;
+}
+
+SparseDecoder::SparseDecoder(std::istream& in)
+    : _in{ in }, _buffer(CODEC_BUFFER_SIZE) {
+    _good = read_bytes(&_header.magic, sizeof(_header.magic))
+        && read_bytes(&_header.flags, sizeof(_header.flags))
+        && read_varint(_header.rows);
+
+    if (_good && _header.magic == CODEC_MAT_MAGIC) {
+        _good = read_varint(_header.cols);
+    }
+    else if (_header.magic != CODEC_VEC_MAGIC) {
+        _good = false;
+    }
+
+    _good = _good
+        && read_varint(_header.nnz)
+        && (_header.flags & ~CODEC_F32_VALUES) == 0
+        && (_header.rows == 0 || _header.cols <= std::numeric_limits<u64>::max() / _header.rows)
+        && _header.nnz <= _header.rows * _header.cols;
+}
+
+bool SparseDecoder::next(u64& idx, f64& value) {
+    if (!_good) {
+        return false;
+    }
+    if (_block_pos == _indices.size()) {
+        if (_decoded == _header.nnz || !read_block()) {
+            return false;
+        }
+    }
+
+    idx = _indices[_block_pos];
+    value = _values[_block_pos];
+    ++_block_pos;
+
+    return true;
+}
+
+bool SparseDecoder::read_block() {
+    u64 count = std::min(CODEC_BLOCK_SIZE, _header.nnz - _decoded);
+    const u64 limit = _header.rows * _header.cols;
+
+    _indices.resize(count);
+    _values.resize(count);
+    _block_pos = 0;
+
+    for (u64 i = 0; i < count; ++i) {
+        u64 gap = 0;
+        if (!read_varint(gap) || gap >= limit - _next_idx) {
+            return _good = false;
+        }
+        _indices[i] = _next_idx + gap;
+        _next_idx = _indices[i] + 1;
+    }
+
+    if (_header.flags & CODEC_F32_VALUES) {
+        _narrow.resize(count);
+        if (!read_bytes(_narrow.data(), count * sizeof(f32))) {
+            return _good = false;
+        }
+        std::copy(_narrow.begin(), _narrow.end(), _values.begin());
+    }
+    else if (!read_bytes(_values.data(), count * sizeof(f64))) {
+        return _good = false;
+    }
+
+    _decoded += count;
+    return true;
+}
+
+bool SparseDecoder::read_varint(u64& value) {
+    // A varint never spans more than CODEC_MAX_VARINT_SIZE bytes, but the stream may end sooner.
+    fill(CODEC_MAX_VARINT_SIZE);
+
+    value = 0;
+    for (u64 shift = 0; shift < 64 && _pos < _end; shift += 7) {
+        u8 byte = static_cast<u8>(_buffer[_pos++]);
+        value |= static_cast<u64>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SparseDecoder::read_bytes(void* data, u64 size) {
+    char* bytes = static_cast<char*>(data);
+
+    while (size != 0) {
+        if (_pos == _end && !fill(1)) {
+            return false;
+        }
+        u64 chunk = std::min(size, _end - _pos);
+        std::memcpy(bytes, _buffer.data() + _pos, chunk);
+
+        _pos += chunk;
+        bytes += chunk;
+        size -= chunk;
+    }
+
+    return true;
+}
+
+// Makes at least `size` bytes available unless the stream ends first.
+bool SparseDecoder::fill(u64 size) {
+    if (_end - _pos >= size) {
+        return true;
+    }
+
+    std::memmove(_buffer.data(), _buffer.data() + _pos, _end - _pos);
+    _end -= _pos;
+    _pos = 0;
+
+    while (_end < size && _in) {
+        _in.read(_buffer.data() + _end, _buffer.size() - _end);
+        _end += _in.gcount();
+    }
+
+    return _end >= size;
+}
+
+bool encode_sorted(std::ostream& out, std::vector<std::pair<u64, f64>>& entries, CodecHeader header) {
+    std::sort(entries.begin(), entries.end(), [](const auto& e1, const auto& e2) {
+        return e1.first < e2.first;
+    });
+
+    SparseEncoder encoder(out, header);
+    for (const auto& [idx, value] : entries) {
+        encoder.push(idx, value);
+    }
+
+    return encoder.finish();
+}
+
+bool encode(std::ostream& out, const Vec& vec, const CodecOptions& options) {
+    std::vector<std::pair<u64, f64>> entries(vec.begin(), vec.end());
+
+    CodecHeader header;
+    header.magic = CODEC_VEC_MAGIC;
+    header.flags = options.f32_values ? CODEC_F32_VALUES : 0;
+    header.rows = vec.get_size();
+    header.nnz = entries.size();
+
+    return encode_sorted(out, entries, header);
+}
+
+bool encode(std::ostream& out, const Mat& mat, const CodecOptions& options) {
+    std::vector<std::pair<u64, f64>> entries;
+    entries.reserve(mat.get_nnz());
+
+    for (const auto& [idx, value] : mat) {
+        entries.emplace_back(idx.first * mat.get_cols() + idx.second, value);
+    }
+
+    CodecHeader header;
+    header.magic = CODEC_MAT_MAGIC;
+    header.flags = options.f32_values ? CODEC_F32_VALUES : 0;
+    header.rows = mat.get_rows();
+    header.cols = mat.get_cols();
+    header.nnz = entries.size();
+
+    return encode_sorted(out, entries, header);
+}
+
+bool decode(std::istream& in, Vec& vec) {
+    SparseDecoder decoder(in);
+    const CodecHeader& header = decoder.get_header();
+
+    if (!decoder.good() || header.magic != CODEC_VEC_MAGIC) {
+        return false;
+    }
+
+    Vec res(header.rows);
+    // nnz is not trusted before the blocks arrive, the map grows past the first one.
+    res.reserve(std::min(header.nnz, CODEC_BLOCK_SIZE));
+
+    u64 idx = 0;
+    f64 value = 0.0;
+    while (decoder.next(idx, value)) {
+        res.set(idx, value);
+    }
+
+    if (!decoder.good()) {
+        return false;
+    }
+
+    vec = std::move(res);
+    return true;
+}
+
+bool decode(std::istream& in, Mat& mat) {
+    SparseDecoder decoder(in);
+    const CodecHeader& header = decoder.get_header();
+
+    if (!decoder.good() || header.magic != CODEC_MAT_MAGIC) {
+        return false;
+    }
+
+    Mat res(header.rows, header.cols);
+    // nnz is not trusted before the blocks arrive, the map grows past the first one.
+    res.reserve(std::min(header.nnz, CODEC_BLOCK_SIZE));
+
+    u64 idx = 0;
+    f64 value = 0.0;
+    while (decoder.next(idx, value)) {
+        res.set(idx / header.cols, idx % header.cols, value);
+    }
+
+    if (!decoder.good()) {
+        return false;
+    }
+
+    mat = std::move(res);
+    return true;
+}
\ No newline at end of file
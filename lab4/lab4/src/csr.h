@@ -0,0 +1,164 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <cassert>
+
+#include "defines.h"
+#include "mat.h"
+#include "dense.h"
+#include "parallel.h"
+
+constexpr u64 CSR_ROW_GRAIN = 1024;
+
+// Compressed sparse row snapshot of a Mat for the kernels that need to walk it row by row
+// many times. Columns are sorted inside every row.
+struct Csr {
+    u64 rows{ 0 };
+    u64 cols{ 0 };
+    std::vector<u64> row_ptr;
+    std::vector<u64> col_idx;
+    std::vector<f64> values;
+
+    Csr() = default;
+    Csr(const Mat& mat);
+
+    u64 get_nnz() const { return values.size(); }
+
+    Csr transpose() const;
+    Mat to_mat() const;
+    DenseMat to_dense() const;
+
+    // y = A * x
+    void mul(const f64* x, f64* y, u64 threads = 0) const;
+    // Y = A * X, X has `rows` == cols of A
+    DenseMat mul(const DenseMat& x, u64 threads = 0) const;
+};
+
+//
+
+Csr::Csr(const Mat& mat)
+    : rows{ mat.get_rows() }, cols{ mat.get_cols() }, row_ptr(mat.get_rows() + 1, 0) {
+    for (const auto& [idx, value] : mat) {
+        ++row_ptr[idx.first + 1];
+    }
+    std::partial_sum(row_ptr.begin(), row_ptr.end(), row_ptr.begin());
+
+    const u64 nnz = row_ptr.back();
+    col_idx.resize(nnz);
+    values.resize(nnz);
+
+    std::vector<u64> fill(row_ptr.begin(), row_ptr.end() - 1);
+    for (const auto& [idx, value] : mat) {
+        u64 pos = fill[idx.first]++;
+        col_idx[pos] = idx.second;
+        values[pos] = value;
+    }
+
+    std::vector<std::pair<u64, f64>> row;
+    for (u64 i = 0; i < rows; ++i) {
+        const u64 begin = row_ptr[i];
+        const u64 end = row_ptr[i + 1];
+        if (std::is_sorted(col_idx.begin() + begin, col_idx.begin() + end)) {
+            continue;
+        }
+
+        row.clear();
+        for (u64 k = begin; k < end; ++k) {
+            row.emplace_back(col_idx[k], values[k]);
+        }
+        std::sort(row.begin(), row.end(), [](const auto& e1, const auto& e2) {
+            return e1.first < e2.first;
+        });
+        for (u64 k = begin; k < end; ++k) {
+            col_idx[k] = row[k - begin].first;
+            values[k] = row[k - begin].second;
+        }
+    }
+}
+
+Csr Csr::transpose() const {
+    Csr res;
+    res.rows = cols;
+    res.cols = rows;
+    res.row_ptr.assign(cols + 1, 0);
+    res.col_idx.resize(get_nnz());
+    res.values.resize(get_nnz());
+
+    for (u64 col : col_idx) {
+        ++res.row_ptr[col + 1];
+    }
+    std::partial_sum(res.row_ptr.begin(), res.row_ptr.end(), res.row_ptr.begin());
+
+    // Walking the rows in order keeps the columns of the result sorted.
+    std::vector<u64> fill(res.row_ptr.begin(), res.row_ptr.end() - 1);
+    for (u64 i = 0; i < rows; ++i) {
+        for (u64 k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+            u64 pos = fill[col_idx[k]]++;
+            res.col_idx[pos] = i;
+            res.values[pos] = values[k];
+        }
+    }
+
+    return res;
+}
+
+Mat Csr::to_mat() const {
+    Mat res(rows, cols);
+    res.reserve(get_nnz());
+
+    for (u64 i = 0; i < rows; ++i) {
+        for (u64 k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+            res.set(i, col_idx[k], values[k]);
+        }
+    }
+
+    return res;
+}
+
+DenseMat Csr::to_dense() const {
+    DenseMat res(rows, cols);
+
+    for (u64 i = 0; i < rows; ++i) {
+        for (u64 k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+            res(i, col_idx[k]) = values[k];
+        }
+    }
+
+    return res;
+}
+
+void Csr::mul(const f64* x, f64* y, u64 threads) const {
+    parallel_for(0, rows, CSR_ROW_GRAIN, [&](u64 lo, u64 hi) {
+        for (u64 i = lo; i < hi; ++i) {
+            f64 sum = 0.0;
+            for (u64 k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+                sum += values[k] * x[col_idx[k]];
+            }
+            y[i] = sum;
+        }
+    }, threads);
+}
+
+DenseMat Csr::mul(const DenseMat& x, u64 threads) const {
+    assert((x.get_rows() == cols) && "Invalid matrices.");
+
+    const u64 width = x.get_cols();
+    DenseMat res(rows, width);
+
+    parallel_for(0, rows, CSR_ROW_GRAIN, [&](u64 lo, u64 hi) {
+        for (u64 i = lo; i < hi; ++i) {
+            f64* out = res.row(i);
+            for (u64 k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+                const f64 a = values[k];
+                const f64* in = x.row(col_idx[k]);
+                for (u64 j = 0; j < width; ++j) {
+                    out[j] += a * in[j];
+                }
+            }
+        }
+    }, threads);
+
+    return res;
+}
\ No newline at end of file
@@ -0,0 +1,385 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <cassert>
+#include <iomanip>
+
+#include "defines.h"
+#include "parallel.h"
+
+// GEMM blocking: a KC x NC panel of B is packed once and stays in L2, the MC x KC block of A
+// a thread works on stays in L1, and every MR x NR tile of C is accumulated in registers.
+constexpr u64 GEMM_MC = 64;
+constexpr u64 GEMM_KC = 256;
+constexpr u64 GEMM_NC = 1024;
+constexpr u64 GEMM_MR = 4;
+constexpr u64 GEMM_NR = 8;
+constexpr u64 TRANSPOSE_BLOCK = 32;
+
+// Contiguous row major dense matrix.
+class DenseMat {
+public:
+    DenseMat(u64 rows, u64 cols);
+    DenseMat(const std::vector<std::vector<f64>>& mat);
+public:
+    u64 get_rows() const { return _rows; }
+    u64 get_cols() const { return _cols; }
+public:
+    f64& operator()(u64 row, u64 col) { return _data[row * _cols + col]; }
+    f64 operator()(u64 row, u64 col) const { return _data[row * _cols + col]; }
+    f64* row(u64 row) { return _data.data() + row * _cols; }
+    const f64* row(u64 row) const { return _data.data() + row * _cols; }
+    f64* data() { return _data.data(); }
+    const f64* data() const { return _data.data(); }
+public:
+    DenseMat transpose() const;
+    // Inverse through the LU factorization, the columns are solved in parallel.
+    DenseMat inverse(u64 threads = 0) const;
+    static DenseMat identity(u64 size);
+public:
+    friend std::ostream& operator<<(std::ostream& out, const DenseMat& mat);
+    friend DenseMat operator*(const DenseMat& m1, const DenseMat& m2);
+    friend DenseMat multiply(const DenseMat& m1, const DenseMat& m2, u64 threads);
+private:
+    u64 _rows{ 0 };
+    u64 _cols{ 0 };
+    std::vector<f64> _data;
+};
+
+// LU factorization with partial pivoting, P * A = L * U. The factorization runs and is stored
+// in T, the substitutions are carried out in f64 against the T factors.
+template<typename T>
+class Lu {
+public:
+    Lu(const DenseMat& mat);
+public:
+    u64 get_size() const { return _n; }
+    bool is_singular() const { return _singular; }
+    // Solves A * x = b in place.
+    void solve(f64* b) const;
+private:
+    u64 _n{ 0 };
+    std::vector<T> _lu;
+    std::vector<u64> _perm;
+    bool _singular{ false };
+};
+
+// Blocked and register tiled m1 * m2, the row blocks of the result are spread over the threads.
+DenseMat multiply(const DenseMat& m1, const DenseMat& m2, u64 threads = 0);
+
+// Eigen decomposition of a small symmetric matrix by cyclic Jacobi rotations.
+// Eigenvalues are sorted in descending order, eigenvectors are the matching columns.
+void symmetric_eigen(const DenseMat& mat, std::vector<f64>& values, DenseMat& vectors);
+
+//
+
+DenseMat::DenseMat(u64 rows, u64 cols)
+    : _rows{ rows }, _cols{ cols }, _data(rows * cols, 0.0) {}
+
+DenseMat::DenseMat(const std::vector<std::vector<f64>>& mat)
+    : _rows{ mat.size() }, _cols{ mat.empty() ? 0 : mat.front().size() }, _data(_rows * _cols) {
+    for (u64 i = 0; i < _rows; ++i) {
+        assert((mat[i].size() == _cols) && "Invalid column size.");
+        std::copy(mat[i].begin(), mat[i].end(), row(i));
+    }
+}
+
+DenseMat DenseMat::transpose() const {
+    DenseMat res(_cols, _rows);
+
+    // Tiles keep both the rows read and the rows written in cache.
+    for (u64 ib = 0; ib < _rows; ib += TRANSPOSE_BLOCK) {
+        const u64 ie = std::min(_rows, ib + TRANSPOSE_BLOCK);
+        for (u64 jb = 0; jb < _cols; jb += TRANSPOSE_BLOCK) {
+            const u64 je = std::min(_cols, jb + TRANSPOSE_BLOCK);
+            for (u64 i = ib; i < ie; ++i) {
+                for (u64 j = jb; j < je; ++j) {
+                    res(j, i) = (*this)(i, j);
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+DenseMat DenseMat::inverse(u64 threads) const {
+    assert((_rows == _cols) && "The matrix must be of the square form.");
+
+    const Lu<f64> lu(*this);
+    assert(!lu.is_singular() && "The matrix is singular.");
+
+    DenseMat res(_rows, _rows);
+    parallel_for(0, _rows, 16, [&](u64 lo, u64 hi) {
+        std::vector<f64> col(_rows);
+        for (u64 j = lo; j < hi; ++j) {
+            std::fill(col.begin(), col.end(), 0.0);
+            col[j] = 1.0;
+            lu.solve(col.data());
+            for (u64 i = 0; i < _rows; ++i) {
+                res(i, j) = col[i];
+            }
+        }
+    }, threads);
+
+    return res;
+}
+
+DenseMat DenseMat::identity(u64 size) {
+    DenseMat res(size, size);
+
+    for (u64 i = 0; i < size; ++i) {
+        res(i, i) = 1.0;
+    }
+
+    return res;
+}
+
+std::ostream& operator<<(std::ostream& out, const DenseMat& mat) {
+    for (u64 i = 0; i < mat._rows; ++i) {
+        for (u64 j = 0; j < mat._cols; ++j) {
+            out << std::setw(5) << mat(i, j);
+        }
+        out << "\n";
+    }
+    return out;
+}
+
+DenseMat operator*(const DenseMat& m1, const DenseMat& m2) {
+    return multiply(m1, m2);
+}
+
+// C[MR x NR] += A[MR x kc] * B panel, the tile lives in registers for the whole k loop.
+// `a` is row major with stride `lda`, `b` is the packed panel with NR values per k.
+void gemm_kernel(u64 kc, const f64* a, u64 lda, const f64* b, f64* c, u64 ldc) {
+    f64 acc[GEMM_MR][GEMM_NR] = {};
+
+    for (u64 k = 0; k < kc; ++k) {
+        const f64* bk = b + k * GEMM_NR;
+        for (u64 r = 0; r < GEMM_MR; ++r) {
+            const f64 ar = a[r * lda + k];
+            for (u64 j = 0; j < GEMM_NR; ++j) {
+                acc[r][j] += ar * bk[j];
+            }
+        }
+    }
+
+    for (u64 r = 0; r < GEMM_MR; ++r) {
+        for (u64 j = 0; j < GEMM_NR; ++j) {
+            c[r * ldc + j] += acc[r][j];
+        }
+    }
+}
+
+// Same as gemm_kernel for the partial tiles on the right and bottom edges.
+void gemm_edge(u64 mr, u64 nr, u64 kc, const f64* a, u64 lda, const f64* b, f64* c, u64 ldc) {
+    for (u64 r = 0; r < mr; ++r) {
+        for (u64 k = 0; k < kc; ++k) {
+            const f64 ar = a[r * lda + k];
+            const f64* bk = b + k * GEMM_NR;
+            for (u64 j = 0; j < nr; ++j) {
+                c[r * ldc + j] += ar * bk[j];
+            }
+        }
+    }
+}
+
+DenseMat multiply(const DenseMat& m1, const DenseMat& m2, u64 threads) {
+    assert(m1._cols == m2._rows && "Invalid matrices.");
+
+    const u64 m = m1._rows;
+    const u64 n = m2._cols;
+    const u64 kk = m1._cols;
+
+    DenseMat res(m, n);
+    std::vector<f64> panel(GEMM_KC * ((std::min(n, GEMM_NC) + GEMM_NR - 1) / GEMM_NR) * GEMM_NR);
+
+    for (u64 jc = 0; jc < n; jc += GEMM_NC) {
+        const u64 nc = std::min(GEMM_NC, n - jc);
+        for (u64 pc = 0; pc < kk; pc += GEMM_KC) {
+            const u64 kc = std::min(GEMM_KC, kk - pc);
+
+            // Pack B[pc:pc+kc, jc:jc+nc] into NR wide strips, zero padded on the right.
+            for (u64 jr = 0; jr < nc; jr += GEMM_NR) {
+                const u64 nr = std::min(GEMM_NR, nc - jr);
+                f64* strip = panel.data() + jr * kc;
+                for (u64 k = 0; k < kc; ++k) {
+                    const f64* src = m2.row(pc + k) + jc + jr;
+                    f64* dst = strip + k * GEMM_NR;
+                    std::copy(src, src + nr, dst);
+                    std::fill(dst + nr, dst + GEMM_NR, 0.0);
+                }
+            }
+
+            parallel_for(0, m, GEMM_MC, [&](u64 lo, u64 hi) {
+                for (u64 ir = lo; ir < hi; ir += GEMM_MR) {
+                    const u64 mr = std::min(GEMM_MR, hi - ir);
+                    const f64* a = m1.row(ir) + pc;
+                    for (u64 jr = 0; jr < nc; jr += GEMM_NR) {
+                        const u64 nr = std::min(GEMM_NR, nc - jr);
+                        const f64* b = panel.data() + jr * kc;
+                        f64* c = res.row(ir) + jc + jr;
+                        if (mr == GEMM_MR && nr == GEMM_NR) {
+                            gemm_kernel(kc, a, kk, b, c, n);
+                        }
+                        else {
+                            gemm_edge(mr, nr, kc, a, kk, b, c, n);
+                        }
+                    }
+                }
+            }, threads);
+        }
+    }
+
+    return res;
+}
+
+template<typename T>
+Lu<T>::Lu(const DenseMat& mat)
+    : _n{ mat.get_rows() }, _lu(mat.get_rows() * mat.get_cols()), _perm(mat.get_rows()) {
+    assert((mat.get_rows() == mat.get_cols()) && "The matrix must be of the square form.");
+
+    std::transform(mat.data(), mat.data() + _lu.size(), _lu.begin(), [](f64 value) {
+        return static_cast<T>(value);
+    });
+    for (u64 i = 0; i < _n; ++i) {
+        _perm[i] = i;
+    }
+
+    for (u64 k = 0; k < _n; ++k) {
+        u64 pivot = k;
+        for (u64 i = k + 1; i < _n; ++i) {
+            if (std::abs(_lu[i * _n + k]) > std::abs(_lu[pivot * _n + k])) {
+                pivot = i;
+            }
+        }
+        if (_lu[pivot * _n + k] == T(0)) {
+            _singular = true;
+            continue;
+        }
+        if (pivot != k) {
+            std::swap_ranges(_lu.begin() + k * _n, _lu.begin() + (k + 1) * _n, _lu.begin() + pivot * _n);
+            std::swap(_perm[k], _perm[pivot]);
+        }
+
+        const T inv = T(1) / _lu[k * _n + k];
+        for (u64 i = k + 1; i < _n; ++i) {
+            T* row = _lu.data() + i * _n;
+            const T factor = row[k] * inv;
+            row[k] = factor;
+            if (factor == T(0)) {
+                continue;
+            }
+            const T* top = _lu.data() + k * _n;
+            for (u64 j = k + 1; j < _n; ++j) {
+                row[j] -= factor * top[j];
+            }
+        }
+    }
+}
+
+template<typename T>
+void Lu<T>::solve(f64* b) const {
+    assert(!_singular && "The matrix is singular.");
+
+    std::vector<f64> x(_n);
+    for (u64 i = 0; i < _n; ++i) {
+        x[i] = b[_perm[i]];
+    }
+
+    for (u64 i = 0; i < _n; ++i) {
+        const T* row = _lu.data() + i * _n;
+        f64 sum = x[i];
+        for (u64 j = 0; j < i; ++j) {
+            sum -= static_cast<f64>(row[j]) * x[j];
+        }
+        x[i] = sum;
+    }
+    for (u64 i = _n; i-- > 0;) {
+        const T* row = _lu.data() + i * _n;
+        f64 sum = x[i];
+        for (u64 j = i + 1; j < _n; ++j) {
+            sum -= static_cast<f64>(row[j]) * x[j];
+        }
+        x[i] = sum / static_cast<f64>(row[i]);
+    }
+
+    std::copy(x.begin(), x.end(), b);
+}
+
+void symmetric_eigen(const DenseMat& mat, std::vector<f64>& values, DenseMat& vectors) {
+    assert((mat.get_rows() == mat.get_cols()) && "The matrix must be of the square form.");
+
+    const u64 n = mat.get_rows();
+    constexpr u64 MAX_SWEEPS = 100;
+
+    DenseMat a = mat;
+    DenseMat v = DenseMat::identity(n);
+
+    for (u64 sweep = 0; sweep < MAX_SWEEPS; ++sweep) {
+        f64 off = 0.0;
+        f64 diag = 0.0;
+        for (u64 i = 0; i < n; ++i) {
+            diag += a(i, i) * a(i, i);
+            for (u64 j = i + 1; j < n; ++j) {
+                off += a(i, j) * a(i, j);
+            }
+        }
+        if (off <= EPSILON * EPSILON * diag || off == 0.0) {
+            break;
+        }
+
+        for (u64 p = 0; p < n; ++p) {
+            for (u64 q = p + 1; q < n; ++q) {
+                const f64 apq = a(p, q);
+                if (apq == 0.0) {
+                    continue;
+                }
+
+                const f64 theta = (a(q, q) - a(p, p)) / (2.0 * apq);
+                const f64 t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                const f64 c = 1.0 / std::sqrt(t * t + 1.0);
+                const f64 s = t * c;
+
+                for (u64 k = 0; k < n; ++k) {
+                    const f64 akp = a(k, p);
+                    const f64 akq = a(k, q);
+                    a(k, p) = c * akp - s * akq;
+                    a(k, q) = s * akp + c * akq;
+                }
+                for (u64 k = 0; k < n; ++k) {
+                    const f64 apk = a(p, k);
+                    const f64 aqk = a(q, k);
+                    a(p, k) = c * apk - s * aqk;
+                    a(q, k) = s * apk + c * aqk;
+                }
+                for (u64 k = 0; k < n; ++k) {
+                    const f64 vkp = v(k, p);
+                    const f64 vkq = v(k, q);
+                    v(k, p) = c * vkp - s * vkq;
+                    v(k, q) = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    std::vector<u64> order(n);
+    for (u64 i = 0; i < n; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&a](u64 i, u64 j) {
+        return a(i, i) > a(j, j);
+    });
+
+    values.resize(n);
+    vectors = DenseMat(n, n);
+    for (u64 j = 0; j < n; ++j) {
+        values[j] = a(order[j], order[j]);
+        for (u64 i = 0; i < n; ++i) {
+            vectors(i, j) = v(i, order[j]);
+        }
+    }
+}
\ No newline at end of file
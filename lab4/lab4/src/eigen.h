@@ -0,0 +1,727 @@
+#pragma once
+#include <vector>
+#include <complex>
+#include <functional>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <cmath>
+#include <cassert>
+
+#include "defines.h"
+#include "mat.h"
+#include "dense.h"
+#include "csr.h"
+#include "parallel.h"
+
+using c64 = std::complex<f64>;
+
+constexpr u64 EIGEN_GRAIN = 4096;
+constexpr f64 EIGEN_EPS23 = 3.7e-11; // machine epsilon to the power 2/3, floor of the relative tolerance
+
+enum class EigenWhich : u32 {
+    LARGEST_MAGNITUDE = 0,
+    SMALLEST_MAGNITUDE = 1,
+    LARGEST_REAL = 2,  // largest algebraic for symmetric problems
+    SMALLEST_REAL = 3, // smallest algebraic for symmetric problems
+};
+
+struct EigenOptions {
+    u64 count{ 6 };
+    EigenWhich which{ EigenWhich::LARGEST_MAGNITUDE };
+    f64 tolerance{ 1e-10 };
+    // Size of the Krylov basis between restarts, 0 picks max(2 * count + 1, 20).
+    u64 restart_length{ 0 };
+    u64 max_restarts{ 1000 };
+    u64 seed{ 0 };
+    u64 threads{ 0 };
+};
+
+// y = A * x, the only way the solvers touch the matrix.
+using LinearOperator = std::function<void(const f64* x, f64* y)>;
+
+struct SymmetricEigen {
+    std::vector<f64> values;
+    DenseMat vectors{ 0, 0 }; // n x count, column j belongs to values[j]
+    u64 restarts{ 0 };
+    u64 products{ 0 };
+    bool converged{ false };
+};
+
+struct GeneralEigen {
+    std::vector<c64> values;
+    std::vector<std::vector<c64>> vectors;
+    u64 restarts{ 0 };
+    u64 products{ 0 };
+    bool converged{ false };
+};
+
+// Thick restart Lanczos with full reorthogonalization for symmetric operators.
+SymmetricEigen lanczos(const LinearOperator& op, u64 n, const EigenOptions& options);
+
+SymmetricEigen lanczos(const Mat& mat, const EigenOptions& options);
+
+// Implicitly restarted Arnoldi with exact shifts for general operators.
+GeneralEigen arnoldi(const LinearOperator& op, u64 n, const EigenOptions& options);
+
+GeneralEigen arnoldi(const Mat& mat, const EigenOptions& options);
+
+// Eigenvalues of an upper Hessenberg matrix by the Francis double shift QR algorithm.
+std::vector<c64> hessenberg_eigenvalues(DenseMat h);
+
+//
+
+// Arnoldi factorization A * V_j = V_j * H_j + H(j, j - 1) * v_j * e_j^T.
+// The basis vectors are the rows of `v`, so memory stays at (m + 1) * n values.
+class KrylovBasis {
+public:
+    KrylovBasis(const LinearOperator& op, u64 n, u64 m, const EigenOptions& options);
+public:
+    u64 get_size() const { return _m; }
+    u64 get_products() const { return _products; }
+    DenseMat& get_h() { return _h; }
+    f64* vector(u64 i) { return _v.row(i); }
+    const f64* vector(u64 i) const { return _v.row(i); }
+public:
+    void expand(u64 from);
+    // Replaces v_0..v_{count - 1} with V_m * Q[:, 0..count).
+    void rotate(const DenseMat& q, u64 count);
+    // x = V_m * y
+    void combine(const f64* y, f64* x) const;
+    // Orthogonalizes w against v_0..v_{count - 1} and returns the projections.
+    void orthogonalize(f64* w, u64 count, f64* coeffs);
+    f64 norm(const f64* w) const;
+    void random_vector(f64* w);
+private:
+    const LinearOperator& _op;
+    u64 _n{ 0 };
+    u64 _m{ 0 };
+    u64 _threads{ 0 };
+    u64 _products{ 0 };
+    DenseMat _v;
+    DenseMat _h;
+    std::vector<f64> _w;
+    std::vector<f64> _coeffs;
+    std::vector<f64> _partial;
+    std::mt19937_64 _engine;
+};
+
+KrylovBasis::KrylovBasis(const LinearOperator& op, u64 n, u64 m, const EigenOptions& options)
+    : _op{ op }, _n{ n }, _m{ m }, _threads{ options.threads },
+    _v(m + 1, n), _h(m + 1, m), _w(n), _coeffs(m + 1), _engine(options.seed) {
+    random_vector(vector(0));
+    f64 beta = norm(vector(0));
+    for (u64 i = 0; i < _n; ++i) {
+        vector(0)[i] /= beta;
+    }
+}
+
+f64 KrylovBasis::norm(const f64* w) const {
+    f64 sum = 0.0;
+    for (u64 i = 0; i < _n; ++i) {
+        sum += w[i] * w[i];
+    }
+    return std::sqrt(sum);
+}
+
+void KrylovBasis::random_vector(f64* w) {
+    std::uniform_real_distribution<f64> dist(-1.0, 1.0);
+    for (u64 i = 0; i < _n; ++i) {
+        w[i] = dist(_engine);
+    }
+}
+
+void KrylovBasis::orthogonalize(f64* w, u64 count, f64* coeffs) {
+    const u64 chunks = (_n + EIGEN_GRAIN - 1) / EIGEN_GRAIN;
+    std::fill(coeffs, coeffs + count, 0.0);
+
+    // Classical Gram-Schmidt applied twice, the partial sums are reduced in chunk order
+    // so the result does not depend on the number of threads.
+    for (u64 pass = 0; pass < 2; ++pass) {
+        _partial.assign(chunks * count, 0.0);
+
+        parallel_for(0, chunks, 1, [&](u64 lo, u64 hi) {
+            for (u64 c = lo; c < hi; ++c) {
+                const u64 begin = c * EIGEN_GRAIN;
+                const u64 end = std::min(_n, begin + EIGEN_GRAIN);
+                for (u64 i = 0; i < count; ++i) {
+                    const f64* v = vector(i);
+                    f64 sum = 0.0;
+                    for (u64 k = begin; k < end; ++k) {
+                        sum += v[k] * w[k];
+                    }
+                    _partial[c * count + i] = sum;
+                }
+            }
+        }, _threads);
+
+        for (u64 i = 0; i < count; ++i) {
+            f64 sum = 0.0;
+            for (u64 c = 0; c < chunks; ++c) {
+                sum += _partial[c * count + i];
+            }
+            _coeffs[i] = sum;
+            coeffs[i] += sum;
+        }
+
+        parallel_for(0, _n, EIGEN_GRAIN, [&](u64 lo, u64 hi) {
+            for (u64 i = 0; i < count; ++i) {
+                const f64* v = vector(i);
+                const f64 c = _coeffs[i];
+                for (u64 k = lo; k < hi; ++k) {
+                    w[k] -= c * v[k];
+                }
+            }
+        }, _threads);
+    }
+}
+
+void KrylovBasis::expand(u64 from) {
+    std::vector<f64> coeffs(_m + 1);
+
+    for (u64 j = from; j < _m; ++j) {
+        _op(vector(j), _w.data());
+        ++_products;
+
+        const f64 scale = norm(_w.data());
+        orthogonalize(_w.data(), j + 1, coeffs.data());
+        for (u64 i = 0; i <= j; ++i) {
+            _h(i, j) = coeffs[i];
+        }
+
+        f64 beta = norm(_w.data());
+        f64* next = vector(j + 1);
+
+        if (beta > 1e-12 * scale) {
+            _h(j + 1, j) = beta;
+            for (u64 k = 0; k < _n; ++k) {
+                next[k] = _w[k] / beta;
+            }
+            continue;
+        }
+
+        // Invariant subspace found, continue with a fresh direction.
+        _h(j + 1, j) = 0.0;
+        random_vector(next);
+        orthogonalize(next, j + 1, coeffs.data());
+        beta = norm(next);
+        for (u64 k = 0; k < _n; ++k) {
+            next[k] = beta > 0.0 ? next[k] / beta : 0.0;
+        }
+    }
+}
+
+void KrylovBasis::rotate(const DenseMat& q, u64 count) {
+    assert((q.get_rows() == _m && count <= q.get_cols()) && "Invalid rotation.");
+
+    parallel_for(0, _n, EIGEN_GRAIN, [&](u64 lo, u64 hi) {
+        DenseMat tmp(count, hi - lo);
+        for (u64 j = 0; j < _m; ++j) {
+            const f64* v = vector(j) + lo;
+            for (u64 i = 0; i < count; ++i) {
+                const f64 c = q(j, i);
+                f64* out = tmp.row(i);
+                for (u64 k = 0; k < hi - lo; ++k) {
+                    out[k] += c * v[k];
+                }
+            }
+        }
+        for (u64 i = 0; i < count; ++i) {
+            std::copy(tmp.row(i), tmp.row(i) + (hi - lo), _v.row(i) + lo);
+        }
+    }, _threads);
+}
+
+void KrylovBasis::combine(const f64* y, f64* x) const {
+    parallel_for(0, _n, EIGEN_GRAIN, [&](u64 lo, u64 hi) {
+        std::fill(x + lo, x + hi, 0.0);
+        for (u64 j = 0; j < _m; ++j) {
+            const f64* v = vector(j);
+            for (u64 k = lo; k < hi; ++k) {
+                x[k] += y[j] * v[k];
+            }
+        }
+    }, _threads);
+}
+
+u64 krylov_size(u64 n, const EigenOptions& options, u64 extra) {
+    u64 m = options.restart_length != 0 ? options.restart_length : std::max<u64>(2 * options.count + 1, 20);
+    m = std::max(m, options.count + extra);
+    return std::min(m, n);
+}
+
+// Order in which Ritz values are wanted, the first `count` are returned.
+template<typename T>
+std::vector<u64> eigen_order(const std::vector<T>& values, EigenWhich which) {
+    std::vector<u64> order(values.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    std::stable_sort(order.begin(), order.end(), [&](u64 i, u64 j) {
+        switch (which) {
+        case EigenWhich::LARGEST_MAGNITUDE: return std::abs(values[i]) > std::abs(values[j]);
+        case EigenWhich::SMALLEST_MAGNITUDE: return std::abs(values[i]) < std::abs(values[j]);
+        case EigenWhich::LARGEST_REAL: return std::real(values[i]) > std::real(values[j]);
+        case EigenWhich::SMALLEST_REAL: return std::real(values[i]) < std::real(values[j]);
+        };
+        return false;
+    });
+
+    return order;
+}
+
+SymmetricEigen lanczos(const LinearOperator& op, u64 n, const EigenOptions& options) {
+    assert((0 < options.count && options.count < n) && "Invalid eigenpair count.");
+
+    const u64 m = krylov_size(n, options, 1);
+    const u64 count = options.count;
+
+    KrylovBasis basis(op, n, m, options);
+    basis.expand(0);
+
+    SymmetricEigen res;
+    DenseMat& h = basis.get_h();
+
+    std::vector<f64> theta;
+    DenseMat s(0, 0);
+    std::vector<u64> order;
+
+    for (;;) {
+        DenseMat t(m, m);
+        for (u64 i = 0; i < m; ++i) {
+            for (u64 j = 0; j < m; ++j) {
+                t(i, j) = 0.5 * (h(i, j) + h(j, i));
+            }
+        }
+        symmetric_eigen(t, theta, s);
+        order = eigen_order(theta, options.which);
+
+        const f64 beta = h(m, m - 1);
+        u64 converged = 0;
+        for (u64 i = 0; i < count; ++i) {
+            f64 residual = std::abs(beta * s(m - 1, order[i]));
+            if (residual <= options.tolerance * std::max(std::abs(theta[order[i]]), EIGEN_EPS23)) {
+                ++converged;
+            }
+        }
+
+        res.converged = converged == count;
+        if (res.converged || res.restarts == options.max_restarts || m == n) {
+            res.converged = res.converged || m == n;
+            break;
+        }
+
+        // Thick restart: keep the best Ritz vectors and the residual direction,
+        // T becomes diagonal with the coupling to v_keep in row `keep`.
+        const u64 keep = std::min(m - 1, count + (m - count) / 2);
+
+        DenseMat q(m, keep);
+        for (u64 j = 0; j < m; ++j) {
+            for (u64 i = 0; i < keep; ++i) {
+                q(j, i) = s(j, order[i]);
+            }
+        }
+        basis.rotate(q, keep);
+        std::copy(basis.vector(m), basis.vector(m) + n, basis.vector(keep));
+
+        h = DenseMat(m + 1, m);
+        for (u64 i = 0; i < keep; ++i) {
+            h(i, i) = theta[order[i]];
+            h(keep, i) = beta * s(m - 1, order[i]);
+        }
+
+        basis.expand(keep);
+        ++res.restarts;
+    }
+
+    res.values.resize(count);
+    res.vectors = DenseMat(n, count);
+
+    std::vector<f64> y(m);
+    std::vector<f64> x(n);
+    for (u64 i = 0; i < count; ++i) {
+        res.values[i] = theta[order[i]];
+        for (u64 j = 0; j < m; ++j) {
+            y[j] = s(j, order[i]);
+        }
+        basis.combine(y.data(), x.data());
+        for (u64 k = 0; k < n; ++k) {
+            res.vectors(k, i) = x[k];
+        }
+    }
+    res.products = basis.get_products();
+
+    return res;
+}
+
+SymmetricEigen lanczos(const Mat& mat, const EigenOptions& options) {
+    assert((mat.get_rows() == mat.get_cols()) && "The matrix must be of the square form.");
+
+    Csr csr(mat);
+    return lanczos([&](const f64* x, f64* y) { csr.mul(x, y, options.threads); }, mat.get_rows(), options);
+}
+
+// Householder reflector P = I - 2 * v * v^T / (v^T * v) applied as P * H * P to rows/cols k..k+2.
+void apply_reflector(DenseMat& h, DenseMat* q, u64 k, u64 row_end, u64 col_begin, const f64 v[3]) {
+    const f64 vv = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+    if (vv == 0.0) {
+        return;
+    }
+    const f64 scale = 2.0 / vv;
+    const u64 n = h.get_cols();
+
+    for (u64 c = col_begin; c < n; ++c) {
+        f64 d = scale * (v[0] * h(k, c) + v[1] * h(k + 1, c) + v[2] * h(k + 2, c));
+        h(k, c) -= d * v[0];
+        h(k + 1, c) -= d * v[1];
+        h(k + 2, c) -= d * v[2];
+    }
+    for (u64 r = 0; r <= row_end; ++r) {
+        f64 d = scale * (v[0] * h(r, k) + v[1] * h(r, k + 1) + v[2] * h(r, k + 2));
+        h(r, k) -= d * v[0];
+        h(r, k + 1) -= d * v[1];
+        h(r, k + 2) -= d * v[2];
+    }
+    if (q) {
+        for (u64 r = 0; r < q->get_rows(); ++r) {
+            f64 d = scale * (v[0] * (*q)(r, k) + v[1] * (*q)(r, k + 1) + v[2] * (*q)(r, k + 2));
+            (*q)(r, k) -= d * v[0];
+            (*q)(r, k + 1) -= d * v[1];
+            (*q)(r, k + 2) -= d * v[2];
+        }
+    }
+}
+
+// Rotation G mapping (x, y) to (r, 0) applied as G * H * G^T to rows/cols k, k+1.
+void apply_rotation(DenseMat& h, DenseMat* q, u64 k, u64 row_end, u64 col_begin, f64 x, f64 y) {
+    const f64 r = std::hypot(x, y);
+    if (r == 0.0) {
+        return;
+    }
+    const f64 c = x / r;
+    const f64 s = y / r;
+    const u64 n = h.get_cols();
+
+    for (u64 col = col_begin; col < n; ++col) {
+        f64 a = h(k, col);
+        f64 b = h(k + 1, col);
+        h(k, col) = c * a + s * b;
+        h(k + 1, col) = -s * a + c * b;
+    }
+    for (u64 row = 0; row <= row_end; ++row) {
+        f64 a = h(row, k);
+        f64 b = h(row, k + 1);
+        h(row, k) = c * a + s * b;
+        h(row, k + 1) = -s * a + c * b;
+    }
+    if (q) {
+        for (u64 row = 0; row < q->get_rows(); ++row) {
+            f64 a = (*q)(row, k);
+            f64 b = (*q)(row, k + 1);
+            (*q)(row, k) = c * a + s * b;
+            (*q)(row, k + 1) = -s * a + c * b;
+        }
+    }
+}
+
+// One implicit single shift QR step on the active block lo..hi.
+void francis_single_step(DenseMat& h, DenseMat* q, u64 lo, u64 hi, f64 mu) {
+    f64 x = h(lo, lo) - mu;
+    f64 y = h(lo + 1, lo);
+
+    for (u64 k = lo; k < hi; ++k) {
+        apply_rotation(h, q, k, std::min(k + 2, hi), k > lo ? k - 1 : lo, x, y);
+        if (k + 1 < hi) {
+            x = h(k + 1, k);
+            y = h(k + 2, k);
+        }
+    }
+}
+
+// One implicit double shift QR step with the shifts being the roots of z^2 - s * z + t.
+void francis_double_step(DenseMat& h, DenseMat* q, u64 lo, u64 hi, f64 s, f64 t) {
+    f64 x = h(lo, lo) * h(lo, lo) + h(lo, lo + 1) * h(lo + 1, lo) - s * h(lo, lo) + t;
+    f64 y = h(lo + 1, lo) * (h(lo, lo) + h(lo + 1, lo + 1) - s);
+    f64 z = h(lo + 1, lo) * h(lo + 2, lo + 1);
+
+    for (u64 k = lo; k + 2 <= hi; ++k) {
+        const f64 alpha = (x >= 0.0 ? -1.0 : 1.0) * std::sqrt(x * x + y * y + z * z);
+        const f64 v[3] = { x - alpha, y, z };
+
+        apply_reflector(h, q, k, std::min(k + 3, hi), k > lo ? k - 1 : lo, v);
+
+        x = h(k + 1, k);
+        y = h(k + 2, k);
+        if (k + 3 <= hi) {
+            z = h(k + 3, k);
+        }
+    }
+
+    apply_rotation(h, q, hi - 1, hi, hi - 2, x, y);
+}
+
+void eigenvalues_2x2(f64 a, f64 b, f64 c, f64 d, c64& e1, c64& e2) {
+    const f64 half = 0.5 * (a + d);
+    const f64 disc = 0.25 * (a - d) * (a - d) + b * c;
+
+    if (disc >= 0.0) {
+        const f64 root = std::sqrt(disc);
+        e1 = half + root;
+        e2 = half - root;
+    }
+    else {
+        const f64 root = std::sqrt(-disc);
+        e1 = c64(half, root);
+        e2 = c64(half, -root);
+    }
+}
+
+std::vector<c64> hessenberg_eigenvalues(DenseMat h) {
+    const u64 n = h.get_rows();
+    std::vector<c64> res(n);
+
+    u64 iterations = 0;
+    i64 hi = static_cast<i64>(n) - 1;
+
+    while (hi >= 0) {
+        i64 lo = hi;
+        while (lo > 0) {
+            f64 scale = std::abs(h(lo - 1, lo - 1)) + std::abs(h(lo, lo));
+            if (std::abs(h(lo, lo - 1)) <= 1e-16 * (scale == 0.0 ? 1.0 : scale)) {
+                h(lo, lo - 1) = 0.0;
+                break;
+            }
+            --lo;
+        }
+
+        if (lo == hi) {
+            res[hi] = h(hi, hi);
+            --hi;
+            iterations = 0;
+            continue;
+        }
+        if (lo == hi - 1) {
+            eigenvalues_2x2(h(lo, lo), h(lo, hi), h(hi, lo), h(hi, hi), res[lo], res[hi]);
+            hi -= 2;
+            iterations = 0;
+            continue;
+        }
+
+        f64 s = h(hi - 1, hi - 1) + h(hi, hi);
+        f64 t = h(hi - 1, hi - 1) * h(hi, hi) - h(hi - 1, hi) * h(hi, hi - 1);
+
+        // Exceptional shifts break the rare cycles of the standard ones.
+        if (++iterations % 10 == 0) {
+            f64 w = std::abs(h(hi, hi - 1)) + std::abs(h(hi - 1, hi - 2));
+            s = 1.5 * w;
+            t = w * w;
+        }
+        assert((iterations < 30 * n) && "QR iterations did not converge.");
+
+        francis_double_step(h, nullptr, lo, hi, s, t);
+    }
+
+    return res;
+}
+
+// Eigenvector of H for the eigenvalue theta by inverse iteration in complex arithmetic.
+std::vector<c64> hessenberg_eigenvector(const DenseMat& h, u64 m, c64 theta) {
+    f64 norm = 0.0;
+    for (u64 i = 0; i < m; ++i) {
+        for (u64 j = 0; j < m; ++j) {
+            norm = std::max(norm, std::abs(h(i, j)));
+        }
+    }
+    const f64 tiny = std::max(norm, 1.0) * 1e-14;
+
+    std::vector<c64> y(m, c64(1.0, 0.0));
+    std::vector<c64> a(m * m);
+
+    for (u64 iteration = 0; iteration < 3; ++iteration) {
+        for (u64 i = 0; i < m; ++i) {
+            for (u64 j = 0; j < m; ++j) {
+                a[i * m + j] = h(i, j) - (i == j ? theta : c64(0.0, 0.0));
+            }
+        }
+
+        // Gaussian elimination with partial pivoting, singular pivots are nudged.
+        for (u64 k = 0; k < m; ++k) {
+            u64 pivot = k;
+            for (u64 i = k + 1; i < m; ++i) {
+                if (std::abs(a[i * m + k]) > std::abs(a[pivot * m + k])) {
+                    pivot = i;
+                }
+            }
+            if (pivot != k) {
+                std::swap_ranges(a.begin() + k * m, a.begin() + (k + 1) * m, a.begin() + pivot * m);
+                std::swap(y[k], y[pivot]);
+            }
+            if (std::abs(a[k * m + k]) < tiny) {
+                a[k * m + k] = tiny;
+            }
+            for (u64 i = k + 1; i < m; ++i) {
+                c64 factor = a[i * m + k] / a[k * m + k];
+                if (factor == c64(0.0, 0.0)) {
+                    continue;
+                }
+                for (u64 j = k; j < m; ++j) {
+                    a[i * m + j] -= factor * a[k * m + j];
+                }
+                y[i] -= factor * y[k];
+            }
+        }
+        for (u64 k = m; k-- > 0;) {
+            c64 sum = y[k];
+            for (u64 j = k + 1; j < m; ++j) {
+                sum -= a[k * m + j] * y[j];
+            }
+            y[k] = sum / a[k * m + k];
+        }
+
+        f64 length = 0.0;
+        for (const auto& value : y) {
+            length += std::norm(value);
+        }
+        length = std::sqrt(length);
+        for (auto& value : y) {
+            value /= length;
+        }
+    }
+
+    return y;
+}
+
+GeneralEigen arnoldi(const LinearOperator& op, u64 n, const EigenOptions& options) {
+    assert((0 < options.count && options.count + 1 < n) && "Invalid eigenpair count.");
+
+    const u64 m = krylov_size(n, options, 2);
+    const u64 count = options.count;
+
+    KrylovBasis basis(op, n, m, options);
+    basis.expand(0);
+
+    GeneralEigen res;
+    DenseMat& h = basis.get_h();
+
+    std::vector<c64> theta;
+    std::vector<u64> order;
+    std::vector<std::vector<c64>> ritz(count);
+
+    for (;;) {
+        DenseMat hm(m, m);
+        for (u64 i = 0; i < m; ++i) {
+            std::copy(h.row(i), h.row(i) + m, hm.row(i));
+        }
+
+        theta = hessenberg_eigenvalues(hm);
+        order = eigen_order(theta, options.which);
+
+        const f64 beta = h(m, m - 1);
+        u64 converged = 0;
+        for (u64 i = 0; i < count; ++i) {
+            ritz[i] = hessenberg_eigenvector(hm, m, theta[order[i]]);
+            f64 residual = beta * std::abs(ritz[i][m - 1]);
+            if (residual <= options.tolerance * std::max(std::abs(theta[order[i]]), EIGEN_EPS23)) {
+                ++converged;
+            }
+        }
+
+        res.converged = converged == count;
+        if (res.converged || res.restarts == options.max_restarts || m == n) {
+            res.converged = res.converged || m == n;
+            break;
+        }
+
+        // Keep a few converged vectors beyond `count` to avoid stagnation,
+        // and never separate a complex conjugate pair.
+        u64 k = std::min(count + std::min(converged, (m - count) / 2), m - 2);
+        if (theta[order[k - 1]].imag() != 0.0 && theta[order[k]] == std::conj(theta[order[k - 1]])) {
+            ++k;
+        }
+
+        // Exact shifts with the unwanted Ritz values.
+        DenseMat q = DenseMat::identity(m);
+        for (u64 i = k; i < m; ++i) {
+            const c64 mu = theta[order[i]];
+            if (mu.imag() == 0.0) {
+                francis_single_step(hm, &q, 0, m - 1, mu.real());
+            }
+            else if (mu.imag() > 0.0) {
+                francis_double_step(hm, &q, 0, m - 1, 2.0 * mu.real(), std::norm(mu));
+            }
+        }
+
+        // f_k = V_m * q_k * H(k, k - 1) + f_m * Q(m - 1, k - 1)
+        std::vector<f64> f(n);
+        std::vector<f64> qk(m);
+        for (u64 j = 0; j < m; ++j) {
+            qk[j] = q(j, k) * hm(k, k - 1);
+        }
+        basis.combine(qk.data(), f.data());
+
+        const f64* residual = basis.vector(m);
+        for (u64 i = 0; i < n; ++i) {
+            f[i] += beta * q(m - 1, k - 1) * residual[i];
+        }
+
+        basis.rotate(q, k);
+
+        h = DenseMat(m + 1, m);
+        for (u64 i = 0; i < k; ++i) {
+            for (u64 j = 0; j < k; ++j) {
+                h(i, j) = hm(i, j);
+            }
+        }
+
+        std::vector<f64> coeffs(k);
+        basis.orthogonalize(f.data(), k, coeffs.data());
+        f64 f_norm = basis.norm(f.data());
+        if (f_norm < 1e-14) {
+            basis.random_vector(f.data());
+            basis.orthogonalize(f.data(), k, coeffs.data());
+            f_norm = basis.norm(f.data());
+            h(k, k - 1) = 0.0;
+        }
+        else {
+            h(k, k - 1) = f_norm;
+        }
+        for (u64 i = 0; i < n; ++i) {
+            basis.vector(k)[i] = f[i] / f_norm;
+        }
+
+        basis.expand(k);
+        ++res.restarts;
+    }
+
+    res.values.resize(count);
+    res.vectors.resize(count);
+
+    std::vector<f64> y_re(m);
+    std::vector<f64> y_im(m);
+    std::vector<f64> x_re(n);
+    std::vector<f64> x_im(n);
+    for (u64 i = 0; i < count; ++i) {
+        res.values[i] = theta[order[i]];
+        for (u64 j = 0; j < m; ++j) {
+            y_re[j] = ritz[i][j].real();
+            y_im[j] = ritz[i][j].imag();
+        }
+        basis.combine(y_re.data(), x_re.data());
+        basis.combine(y_im.data(), x_im.data());
+
+        res.vectors[i].resize(n);
+        for (u64 k = 0; k < n; ++k) {
+            res.vectors[i][k] = c64(x_re[k], x_im[k]);
+        }
+    }
+    res.products = basis.get_products();
+
+    return res;
+}
+
+GeneralEigen arnoldi(const Mat& mat, const EigenOptions& options) {
+    assert((mat.get_rows() == mat.get_cols()) && "The matrix must be of the square form.");
+
+    Csr csr(mat);
+    return arnoldi([&](const f64* x, f64* y) { csr.mul(x, y, options.threads); }, mat.get_rows(), options);
+}
\ No newline at end of file
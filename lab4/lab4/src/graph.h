@@ -0,0 +1,331 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+#include "defines.h"
+#include "mat.h"
+#include "csr.h"
+#include "parallel.h"
+
+constexpr u64 GRAPH_GRAIN = 2048;
+
+// Graph over an adjacency matrix, every non zero A(u, v) is an edge u -> v.
+// Keeps both directions, out edges for pushing and in edges for pulling.
+struct Graph {
+    Csr out;
+    Csr in;
+
+    Graph(const Mat& adjacency);
+
+    u64 get_vertices() const { return out.rows; }
+    u64 get_edges() const { return out.get_nnz(); }
+    u64 get_out_degree(u64 v) const { return out.row_ptr[v + 1] - out.row_ptr[v]; }
+};
+
+struct GraphReport {
+    u64 iterations{ 0 };
+    u64 pull_iterations{ 0 };
+    u64 edges{ 0 };
+    f64 residual{ 0.0 };
+    bool converged{ true };
+    f64 seconds{ 0.0 };
+
+    f64 get_edges_per_second() const { return seconds > 0.0 ? static_cast<f64>(edges) / seconds : 0.0; }
+};
+
+struct BfsOptions {
+    // Beamer's heuristics: pull once the frontier has more than 1 / alpha of the unexplored
+    // edges, push again once it holds less than 1 / beta of the vertices.
+    f64 alpha{ 15.0 };
+    f64 beta{ 18.0 };
+    u64 threads{ 0 };
+};
+
+struct PageRankOptions {
+    f64 damping{ 0.85 };
+    f64 tolerance{ 1e-9 };
+    u64 max_iterations{ 100 };
+    u64 threads{ 0 };
+};
+
+// Level of every vertex reachable from `source`, -1 for the others.
+std::vector<i64> bfs(const Graph& graph, u64 source, const BfsOptions& options = {}, GraphReport* report = nullptr);
+
+// Power iteration, the rank of dangling vertices is spread uniformly.
+std::vector<f64> pagerank(const Graph& graph, const PageRankOptions& options = {}, GraphReport* report = nullptr);
+
+// Weakly connected components, every vertex is labeled with the smallest vertex of its component.
+std::vector<u64> connected_components(const Graph& graph, u64 threads = 0, GraphReport* report = nullptr);
+
+//
+
+Graph::Graph(const Mat& adjacency)
+    : out{ adjacency }, in{ out.transpose() } {
+    assert((adjacency.get_rows() == adjacency.get_cols()) && "The adjacency matrix must be of the square form.");
+}
+
+class GraphTimer {
+    using clock_t = std::chrono::steady_clock;
+public:
+    GraphTimer(GraphReport* report)
+        : _report{ report }, _start{ clock_t::now() } {}
+    ~GraphTimer() {
+        if (_report) {
+            _report->seconds = std::chrono::duration<f64>(clock_t::now() - _start).count();
+        }
+    }
+private:
+    GraphReport* _report;
+    clock_t::time_point _start;
+};
+
+std::vector<i64> bfs(const Graph& graph, u64 source, const BfsOptions& options, GraphReport* report) {
+    const u64 n = graph.get_vertices();
+    assert((source < n) && "Invalid source vertex.");
+
+    GraphReport local;
+    GraphTimer timer(report);
+
+    std::vector<std::atomic<i64>> level(n);
+    for (auto& l : level) {
+        l.store(-1, std::memory_order_relaxed);
+    }
+    level[source].store(0, std::memory_order_relaxed);
+
+    std::vector<u64> frontier{ source };
+    std::vector<u64> next;
+    std::mutex mutex;
+
+    u64 unexplored = graph.get_edges();
+    bool pull = false;
+
+    for (i64 depth = 0; !frontier.empty(); ++depth) {
+        u64 frontier_edges = 0;
+        for (u64 v : frontier) {
+            frontier_edges += graph.get_out_degree(v);
+        }
+        unexplored -= std::min(unexplored, frontier_edges);
+
+        if (!pull && static_cast<f64>(frontier_edges) > static_cast<f64>(unexplored) / options.alpha) {
+            pull = true;
+        }
+        else if (pull && static_cast<f64>(frontier.size()) < static_cast<f64>(n) / options.beta) {
+            pull = false;
+        }
+
+        next.clear();
+        std::atomic<u64> edges{ 0 };
+
+        if (pull) {
+            // Every unvisited vertex looks for a parent in the frontier and stops at the first one.
+            parallel_for(0, n, GRAPH_GRAIN, [&](u64 lo, u64 hi) {
+                std::vector<u64> found;
+                u64 scanned = 0;
+                for (u64 v = lo; v < hi; ++v) {
+                    if (level[v].load(std::memory_order_relaxed) != -1) {
+                        continue;
+                    }
+                    for (u64 k = graph.in.row_ptr[v]; k < graph.in.row_ptr[v + 1]; ++k) {
+                        ++scanned;
+                        if (level[graph.in.col_idx[k]].load(std::memory_order_relaxed) == depth) {
+                            level[v].store(depth + 1, std::memory_order_relaxed);
+                            found.push_back(v);
+                            break;
+                        }
+                    }
+                }
+                edges += scanned;
+                std::lock_guard lock(mutex);
+                next.insert(next.end(), found.begin(), found.end());
+            }, options.threads);
+
+            ++local.pull_iterations;
+        }
+        else {
+            parallel_for(0, frontier.size(), GRAPH_GRAIN / 8, [&](u64 lo, u64 hi) {
+                std::vector<u64> found;
+                u64 scanned = 0;
+                for (u64 i = lo; i < hi; ++i) {
+                    const u64 u = frontier[i];
+                    for (u64 k = graph.out.row_ptr[u]; k < graph.out.row_ptr[u + 1]; ++k) {
+                        ++scanned;
+                        const u64 v = graph.out.col_idx[k];
+                        i64 unvisited = -1;
+                        if (level[v].load(std::memory_order_relaxed) == -1
+                            && level[v].compare_exchange_strong(unvisited, depth + 1, std::memory_order_relaxed)) {
+                            found.push_back(v);
+                        }
+                    }
+                }
+                edges += scanned;
+                std::lock_guard lock(mutex);
+                next.insert(next.end(), found.begin(), found.end());
+            }, options.threads);
+        }
+
+        local.edges += edges;
+        ++local.iterations;
+        std::swap(frontier, next);
+    }
+
+    std::vector<i64> res(n);
+    for (u64 v = 0; v < n; ++v) {
+        res[v] = level[v].load(std::memory_order_relaxed);
+    }
+
+    if (report) {
+        *report = local;
+    }
+    return res;
+}
+
+std::vector<f64> pagerank(const Graph& graph, const PageRankOptions& options, GraphReport* report) {
+    const u64 n = graph.get_vertices();
+    if (n == 0) {
+        return {};
+    }
+
+    GraphReport local;
+    local.converged = false;
+    GraphTimer timer(report);
+
+    std::vector<f64> rank(n, 1.0 / static_cast<f64>(n));
+    std::vector<f64> next(n);
+    std::vector<f64> contrib(n);
+
+    const u64 chunks = (n + GRAPH_GRAIN - 1) / GRAPH_GRAIN;
+    std::vector<f64> dangling_part(chunks);
+    std::vector<f64> delta_part(chunks);
+
+    for (u64 it = 0; it < options.max_iterations; ++it) {
+        parallel_for(0, chunks, 1, [&](u64 lo, u64 hi) {
+            for (u64 c = lo; c < hi; ++c) {
+                f64 dangling = 0.0;
+                for (u64 u = c * GRAPH_GRAIN; u < std::min(n, (c + 1) * GRAPH_GRAIN); ++u) {
+                    const u64 degree = graph.get_out_degree(u);
+                    if (degree == 0) {
+                        dangling += rank[u];
+                        contrib[u] = 0.0;
+                    }
+                    else {
+                        contrib[u] = rank[u] / static_cast<f64>(degree);
+                    }
+                }
+                dangling_part[c] = dangling;
+            }
+        }, options.threads);
+
+        // Chunk partial sums are reduced in order, so the result does not depend on the thread count.
+        f64 dangling = 0.0;
+        for (f64 part : dangling_part) {
+            dangling += part;
+        }
+        const f64 base = (1.0 - options.damping + options.damping * dangling) / static_cast<f64>(n);
+
+        parallel_for(0, chunks, 1, [&](u64 lo, u64 hi) {
+            for (u64 c = lo; c < hi; ++c) {
+                f64 delta = 0.0;
+                for (u64 v = c * GRAPH_GRAIN; v < std::min(n, (c + 1) * GRAPH_GRAIN); ++v) {
+                    f64 sum = 0.0;
+                    for (u64 k = graph.in.row_ptr[v]; k < graph.in.row_ptr[v + 1]; ++k) {
+                        sum += contrib[graph.in.col_idx[k]];
+                    }
+                    next[v] = base + options.damping * sum;
+                    delta += std::abs(next[v] - rank[v]);
+                }
+                delta_part[c] = delta;
+            }
+        }, options.threads);
+
+        local.residual = 0.0;
+        for (f64 part : delta_part) {
+            local.residual += part;
+        }
+        local.edges += graph.get_edges();
+        ++local.iterations;
+        std::swap(rank, next);
+
+        if (local.residual < options.tolerance) {
+            local.converged = true;
+            break;
+        }
+    }
+
+    if (report) {
+        *report = local;
+    }
+    return rank;
+}
+
+// Lock free union find, roots only ever get linked below smaller roots,
+// so the root of a component is its smallest vertex.
+u64 component_find(std::vector<std::atomic<u64>>& parent, u64 v) {
+    for (;;) {
+        u64 p = parent[v].load(std::memory_order_relaxed);
+        if (p == v) {
+            return v;
+        }
+        u64 gp = parent[p].load(std::memory_order_relaxed);
+        if (p != gp) {
+            parent[v].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+        }
+        v = gp;
+    }
+}
+
+void component_union(std::vector<std::atomic<u64>>& parent, u64 a, u64 b) {
+    for (;;) {
+        a = component_find(parent, a);
+        b = component_find(parent, b);
+        if (a == b) {
+            return;
+        }
+        if (a < b) {
+            std::swap(a, b);
+        }
+        u64 expected = a;
+        if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+std::vector<u64> connected_components(const Graph& graph, u64 threads, GraphReport* report) {
+    const u64 n = graph.get_vertices();
+
+    GraphReport local;
+    GraphTimer timer(report);
+
+    std::vector<std::atomic<u64>> parent(n);
+    for (u64 v = 0; v < n; ++v) {
+        parent[v].store(v, std::memory_order_relaxed);
+    }
+
+    parallel_for(0, n, GRAPH_GRAIN, [&](u64 lo, u64 hi) {
+        for (u64 u = lo; u < hi; ++u) {
+            for (u64 k = graph.out.row_ptr[u]; k < graph.out.row_ptr[u + 1]; ++k) {
+                component_union(parent, u, graph.out.col_idx[k]);
+            }
+        }
+    }, threads);
+
+    std::vector<u64> res(n);
+    parallel_for(0, n, GRAPH_GRAIN, [&](u64 lo, u64 hi) {
+        for (u64 v = lo; v < hi; ++v) {
+            res[v] = component_find(parent, v);
+        }
+    }, threads);
+
+    local.iterations = 1;
+    local.edges = graph.get_edges();
+
+    if (report) {
+        *report = local;
+    }
+    return res;
+}
\ No newline at end of file
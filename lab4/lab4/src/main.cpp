@@ -3,10 +3,22 @@
 #include <chrono>
 #include <cassert>
 #include <string>
+#include <sstream>
+#include <random>
 
 #include "defines.h"
 #include "vec.h"
 #include "mat.h"
+#include "chain.h"
+#include "codec.h"
+#include "rsvd.h"
+#include "eigen.h"
+#include "graph.h"
+#include "mixed.h"
+#include "small.h"
+#include "dense.h"
+#include "assemble.h"
+#include "trisolve.h"
 
 constexpr u64 VECTOR_SIZE = 10'000;
 constexpr u64 MATRIX_SIZE = 100;
@@ -37,6 +49,9 @@ public:
         tp_t end = clock_t::now();
         std::cout << std::chrono::duration_cast<MCS>(end - _start);
     }
+    f64 seconds() const {
+        return std::chrono::duration<f64>(clock_t::now() - _start).count();
+    }
 private:
     std::string _name;
     tp_t _start;
@@ -58,6 +73,26 @@ void test_vectors();
 
 void test_matrix();
 
+void test_chain();
+
+void test_codec();
+
+void test_rsvd();
+
+void test_eigen();
+
+void test_graph();
+
+void test_mixed();
+
+void test_small();
+
+void test_dense();
+
+void test_assemble();
+
+void test_trisolve();
+
 //
 
 f64 std_vec_mul(const std::vector<f64>& v1, const std::vector<f64>& v2) {
@@ -218,9 +253,527 @@ void test_matrix() {
     }
 }
 
+std::vector<std::vector<f64>> make_sparse(u64 rows, u64 cols, u64 step) {
+    std::vector<std::vector<f64>> res(rows, std::vector<f64>(cols, 0.0));
+
+    for (u64 i = 0; i < rows; ++i) {
+        for (u64 j = i % step; j < cols; j += step) {
+            res[i][j] = 1.0 + static_cast<f64>((i + j) % 7);
+        }
+    }
+
+    return res;
+}
+
+void test_chain() {
+    Mat a = make_sparse(500, 5, 1);
+    Mat b = make_sparse(5, 500, 1);
+    Mat c = make_sparse(500, 5, 1);
+    Mat d = make_sparse(5, 500, 1);
+
+    {
+        Bench bench("left to right chain");
+
+        Mat res = a * b * c * d;
+
+        std::cout << "nnz: " << res.get_nnz() << "\n";
+    }
+    {
+        Bench bench("planned chain");
+
+        ChainPlan plan = plan_chain({ a, b, c, d });
+        ChainReport report;
+
+        Mat res = chain_product({ a, b, c, d }, plan, &report);
+
+        std::cout << "order: " << plan.to_string() << "\n";
+        std::cout << "estimated flops: " << report.estimated_flops << "\n";
+        std::cout << "actual flops: " << report.actual_flops << "\n";
+        std::cout << "nnz: " << res.get_nnz() << "\n";
+    }
+}
+
+template<typename T>
+void bench_codec(const std::string& name, const T& value, const CodecOptions& options) {
+    std::stringstream stream;
+    // Throughput is measured against the (index, value) pairs the codec replaces.
+    const f64 raw_bytes = static_cast<f64>(value.get_nnz()) * (sizeof(u64) + sizeof(f64));
+
+    {
+        Bench bench(name + " encode");
+
+        encode(stream, value, options);
+
+        std::cout << "bytes per nnz: " << static_cast<f64>(stream.str().size()) / value.get_nnz() << "\n";
+        std::cout << "GB/s: " << raw_bytes / bench.seconds() / 1e9 << "\n";
+    }
+    T res = value;
+    {
+        Bench bench(name + " decode");
+
+        bool ok = decode(stream, res);
+
+        std::cout << "ok: " << ok << ", nnz: " << res.get_nnz() << "\n";
+        std::cout << "GB/s: " << raw_bytes / bench.seconds() / 1e9 << "\n";
+    }
+}
+
+void test_codec() {
+    std::vector<f64> v(VECTOR_SIZE * 100, 0.0);
+    for (u64 i = 0; i < v.size(); i += 3) {
+        v[i] = 1.0 + static_cast<f64>(i % 11);
+    }
+
+    Vec vec = v;
+    Mat mat = make_sparse(MATRIX_SIZE * 10, MATRIX_SIZE * 10, DELTA_STEP);
+
+    bench_codec("vec f64", vec, CodecOptions{});
+    bench_codec("vec f32", vec, CodecOptions{ true });
+    bench_codec("mat f64", mat, CodecOptions{});
+    bench_codec("mat f32", mat, CodecOptions{ true });
+}
+
+void test_rsvd() {
+    constexpr u64 ROWS = 100'000;
+    constexpr u64 COLS = 1'000;
+    constexpr u64 ROW_NNZ = 8;
+
+    Mat mat(ROWS, COLS);
+    mat.reserve(ROWS * ROW_NNZ);
+    for (u64 i = 0; i < ROWS; ++i) {
+        for (u64 k = 0; k < ROW_NNZ; ++k) {
+            u64 j = (i * 7919 + k * 104729) % COLS;
+            mat.set(i, j, 1.0 / static_cast<f64>(1 + j % 50));
+        }
+    }
+
+    Csr csr(mat);
+
+    {
+        const DenseMat single = gaussian_block(10'000, 3, 0, 1);
+        const DenseMat multi = gaussian_block(10'000, 3, 0, 4);
+        std::cout << "same sketch for 1 and 4 threads: " << std::equal(single.row(0), single.row(10'000), multi.row(0)) << "\n";
+    }
+
+    for (u64 threads : { u64{ 1 }, default_thread_count() }) {
+        Bench bench("rsvd threads=" + std::to_string(threads));
+
+        RsvdOptions options;
+        options.rank = 10;
+        options.threads = threads;
+
+        Svd svd = randomized_svd(csr, options);
+
+        std::cout << "top singular values:";
+        for (f64 s : svd.s) {
+            std::cout << " " << s;
+        }
+        std::cout << "\n";
+    }
+}
+
+void test_eigen() {
+    constexpr u64 SIZE = 10'000;
+
+    // Well separated spectrum around the diagonal, skewed off the diagonal for the general case.
+    Mat sym(SIZE, SIZE);
+    Mat gen(SIZE, SIZE);
+    for (u64 i = 0; i < SIZE; ++i) {
+        sym.set(i, i, 1.0 + static_cast<f64>(i));
+        gen.set(i, i, 1.0 + static_cast<f64>(i));
+        if (i + 1 < SIZE) {
+            sym.set(i, i + 1, 0.5);
+            sym.set(i + 1, i, 0.5);
+            gen.set(i, i + 1, 0.5);
+            gen.set(i + 1, i, -0.25);
+        }
+    }
+
+    EigenOptions options;
+    options.count = 4;
+    options.restart_length = 20;
+
+    {
+        Bench bench("lanczos");
+
+        SymmetricEigen res = lanczos(sym, options);
+
+        std::cout << "converged: " << res.converged << ", restarts: " << res.restarts << ", products: " << res.products << "\n";
+        for (f64 value : res.values) {
+            std::cout << value << " ";
+        }
+        std::cout << "\n";
+    }
+    {
+        Bench bench("arnoldi");
+
+        GeneralEigen res = arnoldi(gen, options);
+
+        std::cout << "converged: " << res.converged << ", restarts: " << res.restarts << ", products: " << res.products << "\n";
+        for (const c64& value : res.values) {
+            std::cout << value << " ";
+        }
+        std::cout << "\n";
+    }
+}
+
+void test_graph() {
+    constexpr u64 VERTICES = 200'000;
+    constexpr u64 DEGREE = 8;
+
+    std::mt19937_64 mt;
+    Mat adjacency(VERTICES, VERTICES);
+    adjacency.reserve(VERTICES * DEGREE);
+    for (u64 u = 0; u < VERTICES; ++u) {
+        for (u64 k = 0; k < DEGREE; ++k) {
+            adjacency.set(u, mt() % VERTICES, 1.0);
+        }
+    }
+
+    Graph graph(adjacency);
+    GraphReport report;
+
+    auto print = [&report](const std::string& name) {
+        std::cout << name << ": iterations " << report.iterations
+            << ", pull iterations " << report.pull_iterations
+            << ", residual " << report.residual
+            << ", edges/s " << report.get_edges_per_second() << "\n";
+    };
+
+    bfs(graph, 0, {}, &report);
+    print("bfs");
+
+    pagerank(graph, {}, &report);
+    print("pagerank");
+
+    connected_components(graph, 0, &report);
+    print("components");
+}
+
+template<typename Op>
+void bench_spmv(const std::string& name, const Op& op, u64 bytes, const std::vector<f64>& x, const std::vector<f64>& reference) {
+    constexpr u64 REPEATS = 50;
+    std::vector<f64> y(reference.size());
+
+    Bench bench(name);
+
+    for (u64 i = 0; i < REPEATS; ++i) {
+        op.mul(x.data(), y.data());
+    }
+    const f64 seconds = bench.seconds();
+
+    f64 error = 0.0;
+    f64 norm = 0.0;
+    for (u64 i = 0; i < y.size(); ++i) {
+        error += (y[i] - reference[i]) * (y[i] - reference[i]);
+        norm += reference[i] * reference[i];
+    }
+
+    std::cout << "relative error: " << std::sqrt(error / norm) << "\n";
+    std::cout << "GB/s: " << static_cast<f64>(bytes * REPEATS) / seconds / 1e9 << "\n";
+}
+
+void test_mixed() {
+    constexpr u64 ROWS = 200'000;
+    constexpr u64 ROW_NNZ = 16;
+    constexpr u64 SYSTEM_SIZE = 600;
+
+    std::mt19937_64 mt;
+    std::uniform_real_distribution<f64> dist(-1.0, 1.0);
+
+    Mat mat(ROWS, ROWS);
+    mat.reserve(ROWS * ROW_NNZ);
+    for (u64 i = 0; i < ROWS; ++i) {
+        for (u64 k = 0; k < ROW_NNZ; ++k) {
+            mat.set(i, mt() % ROWS, dist(mt));
+        }
+    }
+
+    const Csr csr(mat);
+    const MixedCsr<f32> csr_f32(csr);
+    const MixedCsr<Bf16> csr_bf16(csr);
+
+    std::vector<f64> x(ROWS);
+    for (auto& value : x) {
+        value = dist(mt);
+    }
+    std::vector<f64> reference(ROWS);
+    csr.mul(x.data(), reference.data());
+
+    // Bytes streamed per product: the matrix, x and y.
+    const u64 vectors = 2 * ROWS * sizeof(f64);
+    const u64 csr_bytes = csr.row_ptr.size() * sizeof(u64) + csr.get_nnz() * (sizeof(u64) + sizeof(f64));
+
+    bench_spmv("spmv f64", csr, csr_bytes + vectors, x, reference);
+    bench_spmv("spmv f32", csr_f32, csr_f32.get_bytes() + vectors, x, reference);
+    bench_spmv("spmv bf16", csr_bf16, csr_bf16.get_bytes() + vectors, x, reference);
+
+    Mat system(SYSTEM_SIZE, SYSTEM_SIZE);
+    Vec rhs(SYSTEM_SIZE);
+    for (u64 i = 0; i < SYSTEM_SIZE; ++i) {
+        system.set(i, i, 4.0 + dist(mt));
+        for (u64 k = 0; k < 8; ++k) {
+            system.set(i, mt() % SYSTEM_SIZE, dist(mt));
+        }
+        rhs.set(i, dist(mt));
+    }
+    {
+        Bench bench("lu f64 solve");
+
+        Lu<f64> lu(Csr(system).to_dense());
+        std::vector<f64> b(SYSTEM_SIZE);
+        for (const auto& [idx, value] : rhs) {
+            b[idx] = value;
+        }
+        lu.solve(b.data());
+    }
+    {
+        Bench bench("f32 lu + refinement solve");
+
+        RefineReport report;
+        refine_solve(system, rhs, {}, &report);
+
+        std::cout << "iterations: " << report.iterations << ", residual: " << report.residual << ", converged: " << report.converged << "\n";
+    }
+}
+
+void test_small() {
+    constexpr u64 REPEATS = 100'000;
+
+    constexpr SmallMat<4, 4> transform({
+        { 2.0, 0.0, 0.0, 1.0 },
+        { 0.0, 3.0, 1.0, 0.0 },
+        { 0.0, 1.0, 1.0, 0.0 },
+        { 1.0, 0.0, 0.0, 1.0 }
+    });
+    // Evaluated by the compiler, a mismatched shape does not compile.
+    constexpr SmallMat<4, 4> unit = transform * transform.inverse();
+    static_assert(unit(0, 0) == 1.0 && unit(1, 2) == 0.0);
+    std::cout << unit << "\n";
+
+    Mat mat(8, 8);
+    for (u64 i = 0; i < 8; ++i) {
+        mat.set(i, i, static_cast<f64>(i + 2));
+        mat.set(i, (i + 1) % 8, 1.0);
+    }
+    insert(mat, 4, 4, extract<4, 4>(mat, 4, 4).inverse());
+    std::cout << mat << "\n";
+
+    {
+        Bench bench("Mat 4x4 products");
+
+        Mat m = { { 2, 0, 0, 1 }, { 0, 3, 1, 0 }, { 0, 1, 1, 0 }, { 1, 0, 0, 1 } };
+        Mat acc = m;
+        for (u64 i = 0; i < REPEATS; ++i) {
+            acc = acc * m;
+            acc = acc * (1.0 / acc.get(0, 0));
+        }
+        std::cout << acc.get(3, 3) << "\n";
+    }
+    {
+        Bench bench("SmallMat 4x4 products");
+
+        SmallMat<4, 4> acc = transform;
+        for (u64 i = 0; i < REPEATS; ++i) {
+            acc = acc * transform;
+            acc = acc * (1.0 / acc(0, 0));
+        }
+        std::cout << acc(3, 3) << "\n";
+    }
+}
+
+void test_dense() {
+    constexpr u64 SIZE = 400;
+    constexpr f64 DENSITIES[] = { 0.001, 0.01, 0.05, 0.1, 0.25, 0.5, 1.0 };
+
+    std::mt19937_64 mt;
+    std::uniform_real_distribution<f64> dist(-1.0, 1.0);
+    std::uniform_real_distribution<f64> coin(0.0, 1.0);
+
+    for (f64 density : DENSITIES) {
+        std::vector<std::vector<f64>> m1(SIZE, std::vector<f64>(SIZE, 0.0));
+        std::vector<std::vector<f64>> m2(SIZE, std::vector<f64>(SIZE, 0.0));
+        for (u64 i = 0; i < SIZE; ++i) {
+            for (u64 j = 0; j < SIZE; ++j) {
+                if (coin(mt) < density) {
+                    m1[i][j] = dist(mt);
+                }
+                if (coin(mt) < density) {
+                    m2[i][j] = dist(mt);
+                }
+            }
+        }
+
+        std::cout << "density " << density << "\n";
+
+        const Mat mat1 = m1;
+        const Mat mat2 = m2;
+        {
+            Bench bench("custom mat mul");
+
+            Mat res = mat1 * mat2;
+        }
+
+        const DenseMat dense1 = m1;
+        const DenseMat dense2 = m2;
+        {
+            Bench bench("dense mat mul");
+
+            DenseMat res = multiply(dense1, dense2);
+
+            std::cout << "GFLOP/s: " << 2.0 * SIZE * SIZE * SIZE / bench.seconds() / 1e9 << "\n";
+        }
+    }
+
+    DenseMat a(SIZE, SIZE);
+    for (u64 i = 0; i < SIZE; ++i) {
+        for (u64 j = 0; j < SIZE; ++j) {
+            a(i, j) = dist(mt) + (i == j ? static_cast<f64>(SIZE) : 0.0);
+        }
+    }
+    {
+        Bench bench("dense inverse");
+
+        DenseMat unit = a * a.inverse();
+
+        f64 error = 0.0;
+        for (u64 i = 0; i < SIZE; ++i) {
+            for (u64 j = 0; j < SIZE; ++j) {
+                error = std::max(error, std::abs(unit(i, j) - (i == j ? 1.0 : 0.0)));
+            }
+        }
+        std::cout << "max error: " << error << "\n";
+    }
+}
+
+void test_assemble() {
+    constexpr u64 GRID = 300;
+
+    Mat a = { { 1, 2 }, { 0, 3 } };
+    Mat b = { { 0, 1 }, { 1, 0 } };
+    std::cout << kron(a, b) << "\n";
+    std::cout << hstack({ a, b }) << "\n";
+    std::cout << vstack({ a, b }) << "\n";
+    std::cout << block_diag({ a, b }) << "\n";
+    std::cout << block({ { &a, nullptr }, { &b, &a } }) << "\n";
+
+    // 2D Laplacian on a GRID x GRID mesh: block tridiagonal, T on the diagonal and -I beside it.
+    Mat t(GRID, GRID);
+    Mat minus_eye(GRID, GRID);
+    for (u64 i = 0; i < GRID; ++i) {
+        t.set(i, i, 4.0);
+        minus_eye.set(i, i, -1.0);
+        if (i + 1 < GRID) {
+            t.set(i, i + 1, -1.0);
+            t.set(i + 1, i, -1.0);
+        }
+    }
+    {
+        Bench bench("laplacian cell by cell");
+
+        Mat res(GRID * GRID, GRID * GRID);
+        for (u64 i = 0; i < GRID; ++i) {
+            for (u64 j = 0; j < GRID; ++j) {
+                const u64 row = i * GRID + j;
+                res.set(row, row, 4.0);
+                if (j > 0) res.set(row, row - 1, -1.0);
+                if (j + 1 < GRID) res.set(row, row + 1, -1.0);
+                if (i > 0) res.set(row, row - GRID, -1.0);
+                if (i + 1 < GRID) res.set(row, row + GRID, -1.0);
+            }
+        }
+        std::cout << "nnz: " << res.get_nnz() << "\n";
+    }
+    {
+        Bench bench("laplacian blocks");
+
+        BlockGrid grid(GRID, std::vector<const Mat*>(GRID, nullptr));
+        for (u64 i = 0; i < GRID; ++i) {
+            grid[i][i] = &t;
+            if (i + 1 < GRID) {
+                grid[i][i + 1] = grid[i + 1][i] = &minus_eye;
+            }
+        }
+        Mat res = block(grid);
+        std::cout << "nnz: " << res.get_nnz() << "\n";
+    }
+    {
+        Bench bench("kron");
+
+        Mat res = kron(t, t);
+        std::cout << "nnz: " << res.get_nnz() << "\n";
+    }
+}
+
+void test_trisolve() {
+    constexpr u64 SIZE = 1'000'000;
+    constexpr u64 ROW_NNZ = 8;
+    constexpr u64 REPEATS = 10;
+
+    std::mt19937_64 mt;
+    std::uniform_real_distribution<f64> dist(-1.0, 1.0);
+
+    Mat mat(SIZE, SIZE);
+    mat.reserve(SIZE * (ROW_NNZ + 1));
+    for (u64 i = 0; i < SIZE; ++i) {
+        mat.set(i, i, 4.0 + dist(mt));
+        for (u64 k = 0; k < ROW_NNZ; ++k) {
+            mat.set(i, mt() % SIZE, dist(mt));
+        }
+    }
+    const Csr csr(mat);
+
+    std::vector<f64> b(SIZE);
+    for (auto& value : b) {
+        value = dist(mt);
+    }
+
+    std::vector<f64> serial = b;
+    {
+        Bench bench("serial lower solve");
+
+        for (u64 r = 0; r < REPEATS; ++r) {
+            serial = b;
+            triangular_solve(csr, serial.data(), Triangle::LOWER);
+        }
+    }
+
+    std::vector<f64> x = b;
+    {
+        Bench bench("level set lower solve");
+
+        TriangularSolver solver(csr, Triangle::LOWER);
+        std::cout << "levels: " << solver.get_levels() << ", widest: " << solver.get_max_width() << "\n";
+        std::cout << "analysis:";
+        bench.time();
+        std::cout << "\n";
+
+        for (u64 r = 0; r < REPEATS; ++r) {
+            x = b;
+            solver.solve(x.data());
+        }
+    }
+
+    f64 error = 0.0;
+    for (u64 i = 0; i < SIZE; ++i) {
+        error = std::max(error, std::abs(x[i] - serial[i]));
+    }
+    std::cout << "max difference: " << error << "\n";
+}
+
 int main(int argc, char* argv) {
     test_vectors();
     test_matrix();
+    test_chain();
+    test_codec();
+    test_rsvd();
+    test_eigen();
+    test_graph();
+    test_mixed();
+    test_small();
+    test_dense();
+    test_assemble();
+    test_trisolve();
 
     //Mat a = { 
     //    {3, 2, 1}, 
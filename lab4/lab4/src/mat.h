@@ -9,13 +9,12 @@
 #include <iomanip>
 
 #include "defines.h"
-#include "vec.h"
 
 template<>
 struct std::hash<std::pair<u64, u64>> {
     u64 operator()(const std::pair<u64, u64>& values) const noexcept {
-        return (std::hash<u64>()(values.first)
-            ^ std::hash<u64>()(values.second));
+        // Plain xor maps (i, j) and (j, i) and every anti diagonal onto a few values.
+        return std::hash<u64>()(values.first * 0x9E3779B97F4A7C15ull + values.second);
     }
 };
 class Vec;
@@ -29,6 +28,11 @@ public:
 public:
     u64 get_rows() const { return _rows; }
     u64 get_cols() const { return _cols; }
+    u64 get_nnz() const { return _data.size(); }
+
+    f64 get(u64 row, u64 col) const;
+    void set(u64 row, u64 col, f64 value);
+    void reserve(u64 nnz) { _data.reserve(nnz); }
 public:
     auto begin() { return _data.begin(); }
     auto end() { return _data.end(); }
@@ -38,6 +42,9 @@ public:
     Mat transpose() const;
     Mat inverse() const;
     Mat power(u64 power) const;
+
+    template<typename F>
+    Mat map(F f) const;
 public:
     friend std::ostream& operator<<(std::ostream& out, const Mat& mat);
     friend Mat operator+(const Mat& m, f64 value);
@@ -50,6 +57,10 @@ public:
     friend Mat operator*(const Mat& m1, const Mat& m2);
 
     friend Mat operator^(const Mat& m, u32 exp);
+
+    friend Mat mul_elem(const Mat& m1, const Mat& m2);
+    friend Mat div_elem(const Mat& m1, const Mat& m2);
+    friend Mat pow_elem(const Mat& m, f64 exp);
 private:
     u64 _rows{ 0 };
     u64 _cols{ 0 };
@@ -77,7 +88,8 @@ Mat::Mat(const std::initializer_list<std::initializer_list<f64>>& mat) {
     }
 }
 
-Mat::Mat(const std::vector<std::vector<f64>>& mat) {
+Mat::Mat(const std::vector<std::vector<f64>>& mat)
+    : _rows{ mat.size() }, _cols{ mat.empty() ? 0 : mat.front().size() } {
     u64 row = 0;
     for (const auto& r : mat) {
         u64 col = 0;
@@ -91,6 +103,24 @@ Mat::Mat(const std::vector<std::vector<f64>>& mat) {
     }
 }
 
+f64 Mat::get(u64 row, u64 col) const {
+    assert((row < _rows && col < _cols) && "Index out of range.");
+
+    auto it = _data.find({ row, col });
+    return it != _data.end() ? it->second : 0.0;
+}
+
+void Mat::set(u64 row, u64 col, f64 value) {
+    assert((row < _rows && col < _cols) && "Index out of range.");
+
+    if (std::abs(value) > EPSILON) {
+        _data[std::pair<u64, u64>{ row, col }] = value;
+    }
+    else {
+        _data.erase(std::pair<u64, u64>{ row, col });
+    }
+}
+
 Mat Mat::transpose() const {
     Mat res(_cols, _rows);
 
@@ -151,22 +181,52 @@ Mat Mat::power(u64 power) const {
     return res;
 }
 
+// Applies f to every element. Implicit zeros are only materialized when f(0) is not zero,
+// otherwise only the stored values are visited.
+template<typename F>
+Mat Mat::map(F f) const {
+    const f64 zero = f(0.0);
+
+    if (std::abs(zero) < EPSILON) {
+        Mat res(*this);
+
+        for (auto& [idx, value] : res._data) {
+            value = f(value);
+        }
+        std::erase_if(res._data, [](const auto& item) {
+            return std::abs(item.second) < EPSILON;
+        });
+
+        return res;
+    }
+
+    Mat res(_rows, _cols);
+    res._data.reserve(_rows * _cols);
+
+    for (u64 i = 0; i < _rows; ++i) {
+        for (u64 j = 0; j < _cols; ++j) {
+            auto it = _data.find({ i, j });
+            res._data.emplace(std::pair<u64, u64>{ i, j }, it != _data.end() ? f(it->second) : zero);
+        }
+    }
+
+    return res;
+}
+
 std::ostream& operator<<(std::ostream& out, const Mat& mat) {
     for (u64 i = 0; i < mat._rows; ++i) {
         for (u64 j = 0; j < mat._cols; ++j) {
             out << std::setw(5);
-            if (mat._data.contains(std::pair<u64, u64>{ i, j })) {
-                out << mat._data.at({ i, j });
+            auto it = mat._data.find({ i, j });
+            if (it != mat._data.end()) {
+                out << it->second;
             }
             else {
                 out << 0.0;
             }
         }
-        if (i + 1 < mat._cols) {
-            std::cout << "\n";
-        }
+        out << "\n";
     }
-    std::cout << std::endl;
     return out;
 }
 
@@ -329,12 +389,25 @@ Mat operator*(const Mat& m1, const Mat& m2) {
 
     Mat res(rows, cols);
 
+    // Bucket m2 by row once, so every value of m1 only meets the row it is multiplied with.
+    std::vector<u64> row_start(m2._rows + 1, 0);
+    for (const auto& [idx2, value2] : m2) {
+        ++row_start[idx2.first + 1];
+    }
+    for (u64 i = 0; i < m2._rows; ++i) {
+        row_start[i + 1] += row_start[i];
+    }
+
+    std::vector<std::pair<u64, f64>> row_values(m2._data.size());
+    std::vector<u64> row_fill(row_start.begin(), row_start.end() - 1);
+    for (const auto& [idx2, value2] : m2) {
+        row_values[row_fill[idx2.first]++] = { idx2.second, value2 };
+    }
+
     for (const auto& [idx1, value1] : m1) {
-        for (const auto& [idx2, value2] : m2) {
-            if (idx1.second == idx2.first) {
-                f64 value = value1 * value2;
-                res._data[std::pair<u64, u64>(idx1.first, idx2.second)] += value;
-            }
+        for (u64 k = row_start[idx1.second]; k < row_start[idx1.second + 1]; ++k) {
+            const auto& [col, value2] = row_values[k];
+            res._data[std::pair<u64, u64>(idx1.first, col)] += value1 * value2;
         }
     }
 
@@ -364,4 +437,54 @@ Mat operator^(const Mat& m, u32 exp) {
     }
 
     return res;
+}
+
+Mat mul_elem(const Mat& m1, const Mat& m2) {
+    assert(m1._rows == m2._rows && m1._cols == m2._cols && "The matrices must be the same size.");
+
+    // The product is non zero only on the intersection of both patterns,
+    // so walk the smaller one and probe the larger one.
+    const Mat& small = m1._data.size() <= m2._data.size() ? m1 : m2;
+    const Mat& large = m1._data.size() <= m2._data.size() ? m2 : m1;
+
+    Mat res(m1._rows, m1._cols);
+    res._data.reserve(small._data.size());
+
+    for (const auto& [idx, value] : small._data) {
+        auto it = large._data.find(idx);
+        if (it == large._data.end()) {
+            continue;
+        }
+        f64 mul = value * it->second;
+        if (std::abs(mul) >= EPSILON) {
+            res._data.emplace(idx, mul);
+        }
+    }
+
+    return res;
+}
+
+Mat div_elem(const Mat& m1, const Mat& m2) {
+    assert(m1._rows == m2._rows && m1._cols == m2._cols && "The matrices must be the same size.");
+
+    Mat res(m1._rows, m1._cols);
+    res._data.reserve(m1._data.size());
+
+    for (const auto& [idx, value] : m1._data) {
+        auto it = m2._data.find(idx);
+        assert((it != m2._data.end()) && "Division by zero.");
+
+        // An implicit zero divisor gives the IEEE +-inf or NaN when asserts are off.
+        const f64 divisor = it != m2._data.end() ? it->second : 0.0;
+        f64 div = value / divisor;
+        if (std::abs(div) >= EPSILON) {
+            res._data.emplace(idx, div);
+        }
+    }
+
+    return res;
+}
+
+Mat pow_elem(const Mat& m, f64 exp) {
+    return m.map([exp](f64 value) { return std::pow(value, exp); });
 }
\ No newline at end of file
@@ -0,0 +1,175 @@
+#pragma once
+#include <vector>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <cassert>
+
+#include "defines.h"
+#include "mat.h"
+#include "vec.h"
+#include "dense.h"
+#include "csr.h"
+#include "parallel.h"
+
+// bfloat16: the upper half of an f32, 8 bits of mantissa and the full f32 range.
+struct Bf16 {
+    std::uint16_t bits{ 0 };
+
+    Bf16() = default;
+    Bf16(f32 value);
+
+    operator f32() const;
+};
+
+// CSR with values stored as T (f32 or Bf16) and 32 bit column indices, to halve the bytes
+// streamed per non zero. Every product and sum is accumulated in f64.
+template<typename T>
+struct MixedCsr {
+    u64 rows{ 0 };
+    u64 cols{ 0 };
+    std::vector<u64> row_ptr;
+    std::vector<std::uint32_t> col_idx;
+    std::vector<T> values;
+
+    MixedCsr(const Csr& csr);
+
+    u64 get_nnz() const { return values.size(); }
+    u64 get_bytes() const;
+
+    // y = A * x
+    void mul(const f64* x, f64* y, u64 threads = 0) const;
+};
+
+struct RefineOptions {
+    f64 tolerance{ 1e-14 };
+    u64 max_iterations{ 20 };
+    u64 threads{ 0 };
+};
+
+struct RefineReport {
+    u64 iterations{ 0 };
+    f64 residual{ 0.0 }; // ||b - A * x|| / ||b||
+    bool converged{ false };
+};
+
+// Solves A * x = b to f64 accuracy from an LU factorization carried out in f32:
+// the residual is computed in f64 and corrected with the cheap factorization until it stalls.
+Vec refine_solve(const Mat& a, const Vec& b, const RefineOptions& options = {}, RefineReport* report = nullptr);
+
+//
+
+Bf16::Bf16(f32 value) {
+    std::uint32_t u = 0;
+    std::memcpy(&u, &value, sizeof(u));
+
+    if ((u & 0x7FFFFFFF) > 0x7F800000) {
+        bits = 0x7FC0;
+        return;
+    }
+    // Round to nearest, ties to even.
+    u += 0x7FFF + ((u >> 16) & 1);
+    bits = static_cast<std::uint16_t>(u >> 16);
+}
+
+Bf16::operator f32() const {
+    std::uint32_t u = static_cast<std::uint32_t>(bits) << 16;
+    f32 value = 0.0f;
+    std::memcpy(&value, &u, sizeof(value));
+    return value;
+}
+
+template<typename T>
+MixedCsr<T>::MixedCsr(const Csr& csr)
+    : rows{ csr.rows }, cols{ csr.cols }, row_ptr{ csr.row_ptr }, col_idx(csr.get_nnz()), values(csr.get_nnz()) {
+    assert((csr.cols <= std::numeric_limits<std::uint32_t>::max()) && "Too many columns for 32 bit indices.");
+
+    for (u64 k = 0; k < csr.get_nnz(); ++k) {
+        col_idx[k] = static_cast<std::uint32_t>(csr.col_idx[k]);
+        values[k] = T(static_cast<f32>(csr.values[k]));
+    }
+}
+
+template<typename T>
+u64 MixedCsr<T>::get_bytes() const {
+    return row_ptr.size() * sizeof(u64) + col_idx.size() * sizeof(std::uint32_t) + values.size() * sizeof(T);
+}
+
+template<typename T>
+void MixedCsr<T>::mul(const f64* x, f64* y, u64 threads) const {
+    parallel_for(0, rows, CSR_ROW_GRAIN, [&](u64 lo, u64 hi) {
+        for (u64 i = lo; i < hi; ++i) {
+            f64 sum = 0.0;
+            for (u64 k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+                sum += static_cast<f64>(static_cast<f32>(values[k])) * x[col_idx[k]];
+            }
+            y[i] = sum;
+        }
+    }, threads);
+}
+
+Vec refine_solve(const Mat& a, const Vec& b, const RefineOptions& options, RefineReport* report) {
+    assert((a.get_rows() == a.get_cols() && a.get_rows() == b.get_size()) && "Invalid system.");
+
+    const u64 n = a.get_rows();
+    const Csr csr(a);
+    const Lu<f32> lu(csr.to_dense());
+    assert(!lu.is_singular() && "The matrix is singular in f32.");
+
+    std::vector<f64> rhs(n, 0.0);
+    for (const auto& [idx, value] : b) {
+        rhs[idx] = value;
+    }
+
+    f64 b_norm = 0.0;
+    for (f64 value : rhs) {
+        b_norm += value * value;
+    }
+    b_norm = std::sqrt(b_norm);
+
+    std::vector<f64> x(rhs);
+    lu.solve(x.data());
+
+    std::vector<f64> r(n);
+    RefineReport local;
+    f64 previous = std::numeric_limits<f64>::infinity();
+
+    for (;;) {
+        csr.mul(x.data(), r.data(), options.threads);
+
+        f64 r_norm = 0.0;
+        for (u64 i = 0; i < n; ++i) {
+            r[i] = rhs[i] - r[i];
+            r_norm += r[i] * r[i];
+        }
+        local.residual = b_norm > 0.0 ? std::sqrt(r_norm) / b_norm : std::sqrt(r_norm);
+
+        if (local.residual <= options.tolerance) {
+            local.converged = true;
+            break;
+        }
+        // Stop once a correction no longer halves the residual, the f32 factors are too far off.
+        if (local.iterations == options.max_iterations || local.residual > 0.5 * previous) {
+            break;
+        }
+        previous = local.residual;
+
+        lu.solve(r.data());
+        for (u64 i = 0; i < n; ++i) {
+            x[i] += r[i];
+        }
+        ++local.iterations;
+    }
+
+    if (report) {
+        *report = local;
+    }
+
+    Vec res(n);
+    res.reserve(n);
+    for (u64 i = 0; i < n; ++i) {
+        res.set(i, x[i]);
+    }
+    return res;
+}
\ No newline at end of file
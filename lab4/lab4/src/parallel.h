@@ -0,0 +1,52 @@
+#pragma once
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+#include "defines.h"
+
+u64 default_thread_count() {
+    return std::max<u64>(1, std::thread::hardware_concurrency());
+}
+
+// Calls f(lo, hi) for consecutive chunks of [begin, end) of at most `grain` items.
+// Chunks are handed out on demand, so rows of uneven cost still balance across the threads.
+template<typename F>
+void parallel_for(u64 begin, u64 end, u64 grain, F f, u64 threads = 0) {
+    if (begin >= end) {
+        return;
+    }
+    if (threads == 0) {
+        threads = default_thread_count();
+    }
+    grain = std::max<u64>(1, grain);
+    threads = std::min(threads, (end - begin + grain - 1) / grain);
+
+    if (threads <= 1) {
+        f(begin, end);
+        return;
+    }
+
+    std::atomic<u64> next{ begin };
+    auto worker = [&]() {
+        for (;;) {
+            u64 lo = next.fetch_add(grain);
+            if (lo >= end) {
+                return;
+            }
+            f(lo, std::min(end, lo + grain));
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (u64 t = 1; t < threads; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+
+    for (auto& w : workers) {
+        w.join();
+    }
+}
\ No newline at end of file
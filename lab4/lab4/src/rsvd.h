@@ -0,0 +1,265 @@
+#pragma once
+#include <vector>
+#include <random>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+#include "defines.h"
+#include "mat.h"
+#include "dense.h"
+#include "csr.h"
+#include "parallel.h"
+
+constexpr u64 RSVD_ROW_GRAIN = 4096;
+
+struct RsvdOptions {
+    u64 rank{ 10 };
+    u64 oversampling{ 10 };
+    u64 power_iterations{ 2 };
+    u64 seed{ 0 };
+    u64 threads{ 0 };
+};
+
+// A ~= U * diag(S) * V^T, singular values in descending order.
+struct Svd {
+    DenseMat u{ 0, 0 };
+    std::vector<f64> s;
+    DenseMat v{ 0, 0 };
+};
+
+// Block of independent N(0, 1) values. Every chunk of rows has its own engine,
+// so the result only depends on the seed and not on the number of threads.
+DenseMat gaussian_block(u64 rows, u64 cols, u64 seed, u64 threads = 0);
+
+// G = Y^T * Y
+DenseMat gram(const DenseMat& y, u64 threads = 0);
+
+// Y = Y * S for a small square S.
+void mul_small(DenseMat& y, const DenseMat& s, u64 threads = 0);
+
+// Orthonormalizes the columns of a tall matrix in place (shifted Cholesky QR, then Cholesky QR).
+void orthonormalize(DenseMat& y, u64 threads = 0);
+
+// Orthonormal basis of the range of A * Omega with power iterations.
+DenseMat randomized_range(const Csr& a, const Csr& a_t, const RsvdOptions& options);
+
+Svd randomized_svd(const Csr& a, const RsvdOptions& options);
+
+Svd randomized_svd(const Mat& a, const RsvdOptions& options);
+
+//
+
+DenseMat gaussian_block(u64 rows, u64 cols, u64 seed, u64 threads) {
+    DenseMat res(rows, cols);
+
+    // Chunks are fixed RSVD_ROW_GRAIN row ranges whatever parallel_for hands out, so every
+    // chunk is filled by its own engine with 1 thread too.
+    const u64 chunks = (rows + RSVD_ROW_GRAIN - 1) / RSVD_ROW_GRAIN;
+    parallel_for(0, chunks, 1, [&](u64 lo, u64 hi) {
+        for (u64 c = lo; c < hi; ++c) {
+            std::seed_seq seq{ seed, c };
+            std::mt19937_64 engine(seq);
+            std::normal_distribution<f64> dist;
+
+            const u64 end = std::min(rows, (c + 1) * RSVD_ROW_GRAIN);
+            std::generate(res.row(c * RSVD_ROW_GRAIN), res.row(end), [&]() { return dist(engine); });
+        }
+    }, threads);
+
+    return res;
+}
+
+DenseMat gram(const DenseMat& y, u64 threads) {
+    const u64 l = y.get_cols();
+    DenseMat res(l, l);
+    std::mutex mutex;
+
+    parallel_for(0, y.get_rows(), RSVD_ROW_GRAIN, [&](u64 lo, u64 hi) {
+        DenseMat local(l, l);
+        for (u64 r = lo; r < hi; ++r) {
+            const f64* row = y.row(r);
+            for (u64 i = 0; i < l; ++i) {
+                const f64 a = row[i];
+                f64* out = local.row(i);
+                for (u64 j = i; j < l; ++j) {
+                    out[j] += a * row[j];
+                }
+            }
+        }
+
+        std::lock_guard lock(mutex);
+        for (u64 i = 0; i < l; ++i) {
+            for (u64 j = i; j < l; ++j) {
+                res(i, j) += local(i, j);
+            }
+        }
+    }, threads);
+
+    for (u64 i = 0; i < l; ++i) {
+        for (u64 j = 0; j < i; ++j) {
+            res(i, j) = res(j, i);
+        }
+    }
+
+    return res;
+}
+
+void mul_small(DenseMat& y, const DenseMat& s, u64 threads) {
+    assert((y.get_cols() == s.get_rows() && s.get_rows() == s.get_cols()) && "Invalid matrices.");
+
+    const u64 l = s.get_cols();
+
+    parallel_for(0, y.get_rows(), RSVD_ROW_GRAIN, [&](u64 lo, u64 hi) {
+        std::vector<f64> tmp(l);
+        for (u64 r = lo; r < hi; ++r) {
+            f64* row = y.row(r);
+            std::fill(tmp.begin(), tmp.end(), 0.0);
+            for (u64 k = 0; k < l; ++k) {
+                const f64 a = row[k];
+                const f64* in = s.row(k);
+                for (u64 j = 0; j < l; ++j) {
+                    tmp[j] += a * in[j];
+                }
+            }
+            std::copy(tmp.begin(), tmp.end(), row);
+        }
+    }, threads);
+}
+
+// Inverse of the Cholesky factor R of g + shift * I (g = R^T * R).
+// Directions that are numerically zero get a zero column, so they vanish from Y * R^-1.
+DenseMat cholesky_inverse(const DenseMat& g, f64 shift) {
+    const u64 l = g.get_rows();
+    DenseMat r(l, l);
+
+    f64 trace = 0.0;
+    for (u64 i = 0; i < l; ++i) {
+        trace += g(i, i);
+    }
+    const f64 tiny = trace * 1e-28;
+
+    for (u64 j = 0; j < l; ++j) {
+        f64 d = g(j, j) + shift;
+        for (u64 k = 0; k < j; ++k) {
+            d -= r(k, j) * r(k, j);
+        }
+        if (d <= tiny) {
+            continue;
+        }
+        r(j, j) = std::sqrt(d);
+
+        for (u64 i = j + 1; i < l; ++i) {
+            f64 v = g(j, i);
+            for (u64 k = 0; k < j; ++k) {
+                v -= r(k, j) * r(k, i);
+            }
+            r(j, i) = v / r(j, j);
+        }
+    }
+
+    // Back substitution for the upper triangular inverse, column by column.
+    DenseMat inv(l, l);
+    for (u64 j = 0; j < l; ++j) {
+        if (r(j, j) == 0.0) {
+            continue;
+        }
+        inv(j, j) = 1.0 / r(j, j);
+        for (u64 i = j; i-- > 0;) {
+            if (r(i, i) == 0.0) {
+                continue;
+            }
+            f64 v = 0.0;
+            for (u64 k = i + 1; k <= j; ++k) {
+                v += r(i, k) * inv(k, j);
+            }
+            inv(i, j) = -v / r(i, i);
+        }
+    }
+
+    return inv;
+}
+
+void orthonormalize(DenseMat& y, u64 threads) {
+    const u64 m = y.get_rows();
+    const u64 l = y.get_cols();
+
+    // The shift keeps the first factorization positive definite for ill conditioned Y,
+    // the second pass restores orthogonality to working precision.
+    DenseMat g = gram(y, threads);
+    f64 norm = 0.0;
+    for (u64 i = 0; i < l; ++i) {
+        norm += g(i, i);
+    }
+    const f64 shift = 11.0 * static_cast<f64>(m * l + l * (l + 1)) * 1.1e-16 * norm;
+
+    mul_small(y, cholesky_inverse(g, shift), threads);
+    mul_small(y, cholesky_inverse(gram(y, threads), 0.0), threads);
+}
+
+DenseMat randomized_range(const Csr& a, const Csr& a_t, const RsvdOptions& options) {
+    const u64 l = std::min(options.rank + options.oversampling, std::min(a.rows, a.cols));
+
+    DenseMat q = a.mul(gaussian_block(a.cols, l, options.seed, options.threads), options.threads);
+    orthonormalize(q, options.threads);
+
+    for (u64 i = 0; i < options.power_iterations; ++i) {
+        DenseMat w = a_t.mul(q, options.threads);
+        orthonormalize(w, options.threads);
+
+        q = a.mul(w, options.threads);
+        orthonormalize(q, options.threads);
+    }
+
+    return q;
+}
+
+Svd randomized_svd(const Csr& a, const RsvdOptions& options) {
+    assert((options.rank > 0) && "The rank must be positive.");
+
+    const Csr a_t = a.transpose();
+
+    DenseMat q = randomized_range(a, a_t, options);
+    const u64 l = q.get_cols();
+    const u64 k = std::min(options.rank, l);
+
+    // W = A^T * Q = B^T for B = Q^T * A, and W^T * W = B * B^T = U_b * S^2 * U_b^T.
+    DenseMat w = a_t.mul(q, options.threads);
+
+    std::vector<f64> lambda;
+    DenseMat u_b(0, 0);
+    symmetric_eigen(gram(w, options.threads), lambda, u_b);
+
+    mul_small(q, u_b, options.threads);
+    mul_small(w, u_b, options.threads);
+
+    Svd res;
+    res.u = DenseMat(a.rows, k);
+    res.v = DenseMat(a.cols, k);
+    res.s.resize(k);
+
+    for (u64 j = 0; j < k; ++j) {
+        res.s[j] = std::sqrt(std::max(lambda[j], 0.0));
+    }
+
+    parallel_for(0, a.rows, RSVD_ROW_GRAIN, [&](u64 lo, u64 hi) {
+        for (u64 i = lo; i < hi; ++i) {
+            std::copy(q.row(i), q.row(i) + k, res.u.row(i));
+        }
+    }, options.threads);
+
+    parallel_for(0, a.cols, RSVD_ROW_GRAIN, [&](u64 lo, u64 hi) {
+        for (u64 i = lo; i < hi; ++i) {
+            for (u64 j = 0; j < k; ++j) {
+                res.v(i, j) = res.s[j] > 0.0 ? w(i, j) / res.s[j] : 0.0;
+            }
+        }
+    }, options.threads);
+
+    return res;
+}
+
+Svd randomized_svd(const Mat& a, const RsvdOptions& options) {
+    return randomized_svd(Csr(a), options);
+}
\ No newline at end of file
@@ -0,0 +1,354 @@
+#pragma once
+#include <iostream>
+#include <array>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include <cassert>
+#include <iomanip>
+
+#include "defines.h"
+#include "mat.h"
+#include "vec.h"
+
+// Calls f(std::integral_constant<u64, I>) for I in [0, N), expanded at compile time.
+template<u64 N, typename F>
+constexpr void unroll(F&& f) {
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (f(std::integral_constant<u64, I>{}), ...);
+    }(std::make_index_sequence<N>{});
+}
+
+constexpr f64 small_abs(f64 value) {
+    return value < 0.0 ? -value : value;
+}
+
+template<u64 N>
+class SmallVec {
+    static_assert(N > 0, "Empty vectors are not supported.");
+public:
+    constexpr SmallVec() = default;
+    constexpr SmallVec(const f64 (&values)[N]) {
+        unroll<N>([&](auto i) { _data[i] = values[i]; });
+    }
+public:
+    static constexpr u64 get_size() { return N; }
+    constexpr f64& operator[](u64 idx) { return _data[idx]; }
+    constexpr f64 operator[](u64 idx) const { return _data[idx]; }
+public:
+    friend std::ostream& operator<<(std::ostream& out, const SmallVec& v) {
+        for (u64 i = 0; i < N; ++i) {
+            out << v[i] << (i + 1 < N ? " " : "");
+        }
+        return out;
+    }
+    friend constexpr SmallVec operator+(const SmallVec& v1, const SmallVec& v2) {
+        SmallVec res;
+        unroll<N>([&](auto i) { res[i] = v1[i] + v2[i]; });
+        return res;
+    }
+    friend constexpr SmallVec operator-(const SmallVec& v1, const SmallVec& v2) {
+        SmallVec res;
+        unroll<N>([&](auto i) { res[i] = v1[i] - v2[i]; });
+        return res;
+    }
+    friend constexpr SmallVec operator*(const SmallVec& v, f64 value) {
+        SmallVec res;
+        unroll<N>([&](auto i) { res[i] = v[i] * value; });
+        return res;
+    }
+    friend constexpr f64 operator*(const SmallVec& v1, const SmallVec& v2) {
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            return ((v1[I] * v2[I]) + ...);
+        }(std::make_index_sequence<N>{});
+    }
+private:
+    std::array<f64, N> _data{};
+};
+
+template<u64 N, u64 M>
+class SmallMat {
+    static_assert(N > 0 && M > 0, "Empty matrices are not supported.");
+public:
+    constexpr SmallMat() = default;
+    constexpr SmallMat(const f64 (&values)[N][M]) {
+        unroll<N>([&](auto i) { unroll<M>([&](auto j) { (*this)(i, j) = values[i][j]; }); });
+    }
+public:
+    static constexpr u64 get_rows() { return N; }
+    static constexpr u64 get_cols() { return M; }
+    constexpr f64& operator()(u64 row, u64 col) { return _data[row * M + col]; }
+    constexpr f64 operator()(u64 row, u64 col) const { return _data[row * M + col]; }
+public:
+    static constexpr SmallMat identity() requires (N == M);
+    constexpr SmallMat<M, N> transpose() const;
+    constexpr f64 determinant() const requires (N == M && N <= 4);
+    constexpr SmallMat inverse() const requires (N == M);
+public:
+    friend std::ostream& operator<<(std::ostream& out, const SmallMat& m) {
+        for (u64 i = 0; i < N; ++i) {
+            for (u64 j = 0; j < M; ++j) {
+                out << std::setw(5) << m(i, j);
+            }
+            out << "\n";
+        }
+        return out;
+    }
+    friend constexpr SmallMat operator+(const SmallMat& m1, const SmallMat& m2) {
+        SmallMat res;
+        unroll<N * M>([&](auto i) { res._data[i] = m1._data[i] + m2._data[i]; });
+        return res;
+    }
+    friend constexpr SmallMat operator-(const SmallMat& m1, const SmallMat& m2) {
+        SmallMat res;
+        unroll<N * M>([&](auto i) { res._data[i] = m1._data[i] - m2._data[i]; });
+        return res;
+    }
+    friend constexpr SmallMat operator*(const SmallMat& m, f64 value) {
+        SmallMat res;
+        unroll<N * M>([&](auto i) { res._data[i] = m._data[i] * value; });
+        return res;
+    }
+private:
+    std::array<f64, N * M> _data{};
+};
+
+// Shapes are template parameters, so mismatched operands fail to compile.
+template<u64 N, u64 K, u64 M>
+constexpr SmallMat<N, M> operator*(const SmallMat<N, K>& m1, const SmallMat<K, M>& m2) {
+    SmallMat<N, M> res;
+    unroll<N>([&](auto i) {
+        unroll<M>([&](auto j) {
+            res(i, j) = [&]<std::size_t... k>(std::index_sequence<k...>) {
+                return ((m1(i, k) * m2(k, j)) + ...);
+            }(std::make_index_sequence<K>{});
+        });
+    });
+    return res;
+}
+
+template<u64 N, u64 M>
+constexpr SmallVec<N> operator*(const SmallMat<N, M>& m, const SmallVec<M>& v) {
+    SmallVec<N> res;
+    unroll<N>([&](auto i) {
+        res[i] = [&]<std::size_t... k>(std::index_sequence<k...>) {
+            return ((m(i, k) * v[k]) + ...);
+        }(std::make_index_sequence<M>{});
+    });
+    return res;
+}
+
+template<u64 N, u64 M>
+constexpr SmallVec<M> operator*(const SmallVec<N>& v, const SmallMat<N, M>& m) {
+    SmallVec<M> res;
+    unroll<M>([&](auto j) {
+        res[j] = [&]<std::size_t... k>(std::index_sequence<k...>) {
+            return ((v[k] * m(k, j)) + ...);
+        }(std::make_index_sequence<N>{});
+    });
+    return res;
+}
+
+template<u64 N, u64 M>
+constexpr SmallMat<N, M> SmallMat<N, M>::identity() requires (N == M) {
+    SmallMat res;
+    unroll<N>([&](auto i) { res(i, i) = 1.0; });
+    return res;
+}
+
+template<u64 N, u64 M>
+constexpr SmallMat<M, N> SmallMat<N, M>::transpose() const {
+    SmallMat<M, N> res;
+    unroll<N>([&](auto i) { unroll<M>([&](auto j) { res(j, i) = (*this)(i, j); }); });
+    return res;
+}
+
+template<u64 N, u64 M>
+constexpr f64 SmallMat<N, M>::determinant() const requires (N == M && N <= 4) {
+    const auto& m = *this;
+
+    if constexpr (N == 1) {
+        return m(0, 0);
+    }
+    else if constexpr (N == 2) {
+        return m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+    }
+    else if constexpr (N == 3) {
+        return m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1))
+            - m(0, 1) * (m(1, 0) * m(2, 2) - m(1, 2) * m(2, 0))
+            + m(0, 2) * (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0));
+    }
+    else {
+        const f64 s0 = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+        const f64 s1 = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+        const f64 s2 = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+        const f64 s3 = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+        const f64 s4 = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+        const f64 s5 = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+        const f64 c5 = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+        const f64 c4 = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+        const f64 c3 = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+        const f64 c2 = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+        const f64 c1 = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+        const f64 c0 = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+}
+
+// Closed form adjugate inverse up to 4x4, Gauss-Jordan with partial pivoting above.
+template<u64 N, u64 M>
+constexpr SmallMat<N, M> SmallMat<N, M>::inverse() const requires (N == M) {
+    const auto& m = *this;
+    SmallMat res;
+
+    if constexpr (N == 1) {
+        assert(m(0, 0) != 0.0 && "The matrix is singular.");
+        res(0, 0) = 1.0 / m(0, 0);
+    }
+    else if constexpr (N == 2) {
+        const f64 det = determinant();
+        assert(det != 0.0 && "The matrix is singular.");
+        const f64 inv = 1.0 / det;
+        res(0, 0) = m(1, 1) * inv;
+        res(0, 1) = -m(0, 1) * inv;
+        res(1, 0) = -m(1, 0) * inv;
+        res(1, 1) = m(0, 0) * inv;
+    }
+    else if constexpr (N == 3) {
+        const f64 det = determinant();
+        assert(det != 0.0 && "The matrix is singular.");
+        const f64 inv = 1.0 / det;
+        res(0, 0) = (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1)) * inv;
+        res(0, 1) = (m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2)) * inv;
+        res(0, 2) = (m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1)) * inv;
+        res(1, 0) = (m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2)) * inv;
+        res(1, 1) = (m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0)) * inv;
+        res(1, 2) = (m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2)) * inv;
+        res(2, 0) = (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0)) * inv;
+        res(2, 1) = (m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1)) * inv;
+        res(2, 2) = (m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0)) * inv;
+    }
+    else if constexpr (N == 4) {
+        // 2x2 minors of the top and bottom row pairs, shared by all cofactors.
+        const f64 s0 = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+        const f64 s1 = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+        const f64 s2 = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+        const f64 s3 = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+        const f64 s4 = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+        const f64 s5 = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+        const f64 c5 = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+        const f64 c4 = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+        const f64 c3 = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+        const f64 c2 = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+        const f64 c1 = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+        const f64 c0 = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+
+        const f64 det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        assert(det != 0.0 && "The matrix is singular.");
+        const f64 inv = 1.0 / det;
+
+        res(0, 0) = (m(1, 1) * c5 - m(1, 2) * c4 + m(1, 3) * c3) * inv;
+        res(0, 1) = (-m(0, 1) * c5 + m(0, 2) * c4 - m(0, 3) * c3) * inv;
+        res(0, 2) = (m(3, 1) * s5 - m(3, 2) * s4 + m(3, 3) * s3) * inv;
+        res(0, 3) = (-m(2, 1) * s5 + m(2, 2) * s4 - m(2, 3) * s3) * inv;
+
+        res(1, 0) = (-m(1, 0) * c5 + m(1, 2) * c2 - m(1, 3) * c1) * inv;
+        res(1, 1) = (m(0, 0) * c5 - m(0, 2) * c2 + m(0, 3) * c1) * inv;
+        res(1, 2) = (-m(3, 0) * s5 + m(3, 2) * s2 - m(3, 3) * s1) * inv;
+        res(1, 3) = (m(2, 0) * s5 - m(2, 2) * s2 + m(2, 3) * s1) * inv;
+
+        res(2, 0) = (m(1, 0) * c4 - m(1, 1) * c2 + m(1, 3) * c0) * inv;
+        res(2, 1) = (-m(0, 0) * c4 + m(0, 1) * c2 - m(0, 3) * c0) * inv;
+        res(2, 2) = (m(3, 0) * s4 - m(3, 1) * s2 + m(3, 3) * s0) * inv;
+        res(2, 3) = (-m(2, 0) * s4 + m(2, 1) * s2 - m(2, 3) * s0) * inv;
+
+        res(3, 0) = (-m(1, 0) * c3 + m(1, 1) * c1 - m(1, 2) * c0) * inv;
+        res(3, 1) = (m(0, 0) * c3 - m(0, 1) * c1 + m(0, 2) * c0) * inv;
+        res(3, 2) = (-m(3, 0) * s3 + m(3, 1) * s1 - m(3, 2) * s0) * inv;
+        res(3, 3) = (m(2, 0) * s3 - m(2, 1) * s1 + m(2, 2) * s0) * inv;
+    }
+    else {
+        SmallMat a = m;
+        res = identity();
+
+        for (u64 k = 0; k < N; ++k) {
+            u64 pivot = k;
+            for (u64 i = k + 1; i < N; ++i) {
+                if (small_abs(a(i, k)) > small_abs(a(pivot, k))) {
+                    pivot = i;
+                }
+            }
+            assert(a(pivot, k) != 0.0 && "The matrix is singular.");
+
+            for (u64 j = 0; j < N; ++j) {
+                std::swap(a(k, j), a(pivot, j));
+                std::swap(res(k, j), res(pivot, j));
+            }
+
+            const f64 inv = 1.0 / a(k, k);
+            for (u64 j = 0; j < N; ++j) {
+                a(k, j) *= inv;
+                res(k, j) *= inv;
+            }
+
+            for (u64 i = 0; i < N; ++i) {
+                if (i == k || a(i, k) == 0.0) {
+                    continue;
+                }
+                const f64 factor = a(i, k);
+                for (u64 j = 0; j < N; ++j) {
+                    a(i, j) -= factor * a(k, j);
+                    res(i, j) -= factor * res(k, j);
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+// Block of `mat` starting at (row, col).
+template<u64 N, u64 M>
+SmallMat<N, M> extract(const Mat& mat, u64 row, u64 col) {
+    assert((row + N <= mat.get_rows() && col + M <= mat.get_cols()) && "Block out of range.");
+
+    SmallMat<N, M> res;
+    for (u64 i = 0; i < N; ++i) {
+        for (u64 j = 0; j < M; ++j) {
+            res(i, j) = mat.get(row + i, col + j);
+        }
+    }
+    return res;
+}
+
+// Writes the block into `mat` at (row, col), zeros of the block clear the cells.
+template<u64 N, u64 M>
+void insert(Mat& mat, u64 row, u64 col, const SmallMat<N, M>& block) {
+    assert((row + N <= mat.get_rows() && col + M <= mat.get_cols()) && "Block out of range.");
+
+    for (u64 i = 0; i < N; ++i) {
+        for (u64 j = 0; j < M; ++j) {
+            mat.set(row + i, col + j, block(i, j));
+        }
+    }
+}
+
+template<u64 N>
+SmallVec<N> extract(const Vec& vec, u64 idx) {
+    assert((idx + N <= vec.get_size()) && "Block out of range.");
+
+    SmallVec<N> res;
+    for (u64 i = 0; i < N; ++i) {
+        res[i] = vec.get(idx + i);
+    }
+    return res;
+}
+
+template<u64 N>
+void insert(Vec& vec, u64 idx, const SmallVec<N>& block) {
+    assert((idx + N <= vec.get_size()) && "Block out of range.");
+
+    for (u64 i = 0; i < N; ++i) {
+        vec.set(idx + i, block[i]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+#include "defines.h"
+#include "csr.h"
+#include "parallel.h"
+
+constexpr u64 TRISOLVE_GRAIN = 256;
+
+enum class Triangle : u32 {
+    LOWER = 0,
+    UPPER = 1,
+};
+
+enum class Diagonal : u32 {
+    NON_UNIT = 0,
+    UNIT = 1, // the diagonal is taken as ones, stored diagonal entries are ignored
+};
+
+// Solves op(T) * x = b in place, T is the chosen triangle of `a` and op(T) is T or its transpose.
+// Entries outside the triangle are ignored.
+void triangular_solve(const Csr& a, f64* x, Triangle triangle, Diagonal diagonal = Diagonal::NON_UNIT, bool transposed = false);
+
+// Level set analysis of a triangular system. Rows of one level only depend on rows of the
+// earlier levels, so a level is solved in parallel. The analysis is done once and the solver
+// is reused for any number of right hand sides.
+class TriangularSolver {
+public:
+    TriangularSolver(const Csr& a, Triangle triangle, Diagonal diagonal = Diagonal::NON_UNIT, bool transposed = false);
+public:
+    u64 get_size() const { return _rows.size(); }
+    u64 get_levels() const { return _level_ptr.size() - 1; }
+    // Rows in the widest level, a rough bound of the usable parallelism.
+    u64 get_max_width() const;
+public:
+    void solve(f64* x, u64 threads = 0) const;
+private:
+    // Row oriented copy of op(T) without the diagonal, and the reciprocal of the diagonal.
+    Csr _factor;
+    std::vector<f64> _inv_diag;
+    std::vector<u64> _level_ptr;
+    std::vector<u64> _rows;
+};
+
+//
+
+// Position of the diagonal entry of row i, or the end of the row if it is not stored.
+u64 diagonal_position(const Csr& a, u64 i) {
+    auto begin = a.col_idx.begin() + a.row_ptr[i];
+    auto end = a.col_idx.begin() + a.row_ptr[i + 1];
+    auto it = std::lower_bound(begin, end, i);
+    return (it != end && *it == i ? it : end) - a.col_idx.begin();
+}
+
+f64 diagonal_value(const Csr& a, u64 i, Diagonal diagonal) {
+    if (diagonal == Diagonal::UNIT) {
+        return 1.0;
+    }
+    const u64 pos = diagonal_position(a, i);
+    assert((pos < a.row_ptr[i + 1] && a.values[pos] != 0.0) && "The matrix is singular.");
+    return a.values[pos];
+}
+
+void triangular_solve(const Csr& a, f64* x, Triangle triangle, Diagonal diagonal, bool transposed) {
+    assert((a.rows == a.cols) && "The matrix must be of the square form.");
+
+    const u64 n = a.rows;
+    const bool lower = triangle == Triangle::LOWER;
+
+    if (!transposed) {
+        // Row oriented, every row gathers the already solved unknowns.
+        for (u64 step = 0; step < n; ++step) {
+            const u64 i = lower ? step : n - 1 - step;
+            f64 sum = x[i];
+            for (u64 k = a.row_ptr[i]; k < a.row_ptr[i + 1]; ++k) {
+                const u64 j = a.col_idx[k];
+                if (lower ? j < i : j > i) {
+                    sum -= a.values[k] * x[j];
+                }
+            }
+            x[i] = sum / diagonal_value(a, i, diagonal);
+        }
+        return;
+    }
+
+    // Column oriented, the transpose of a lower triangle is upper and is solved from the bottom,
+    // every solved unknown scatters into the right hand side of the rows still to come.
+    for (u64 step = 0; step < n; ++step) {
+        const u64 i = lower ? n - 1 - step : step;
+        x[i] /= diagonal_value(a, i, diagonal);
+        const f64 xi = x[i];
+        for (u64 k = a.row_ptr[i]; k < a.row_ptr[i + 1]; ++k) {
+            const u64 j = a.col_idx[k];
+            if (lower ? j < i : j > i) {
+                x[j] -= a.values[k] * xi;
+            }
+        }
+    }
+}
+
+TriangularSolver::TriangularSolver(const Csr& a, Triangle triangle, Diagonal diagonal, bool transposed) {
+    assert((a.rows == a.cols) && "The matrix must be of the square form.");
+
+    const u64 n = a.rows;
+    const bool lower = triangle == Triangle::LOWER;
+
+    Csr strict;
+    strict.rows = strict.cols = n;
+    strict.row_ptr.assign(n + 1, 0);
+    _inv_diag.assign(n, 1.0);
+    for (u64 i = 0; i < n; ++i) {
+        for (u64 k = a.row_ptr[i]; k < a.row_ptr[i + 1]; ++k) {
+            const u64 j = a.col_idx[k];
+            if (lower ? j < i : j > i) {
+                strict.col_idx.push_back(j);
+                strict.values.push_back(a.values[k]);
+            }
+        }
+        strict.row_ptr[i + 1] = strict.col_idx.size();
+        _inv_diag[i] = 1.0 / diagonal_value(a, i, diagonal);
+    }
+
+    // The transpose of the strict part keeps the solve row oriented, so no row ever writes
+    // into another one and the rows of a level are independent.
+    _factor = transposed ? strict.transpose() : std::move(strict);
+    const bool forward = lower != transposed;
+
+    std::vector<u64> level(n, 0);
+    u64 levels = 0;
+    for (u64 step = 0; step < n; ++step) {
+        const u64 i = forward ? step : n - 1 - step;
+        u64 l = 0;
+        for (u64 k = _factor.row_ptr[i]; k < _factor.row_ptr[i + 1]; ++k) {
+            l = std::max(l, level[_factor.col_idx[k]] + 1);
+        }
+        level[i] = l;
+        levels = std::max(levels, l + 1);
+    }
+
+    _level_ptr.assign(levels + 1, 0);
+    for (u64 l : level) {
+        ++_level_ptr[l + 1];
+    }
+    for (u64 l = 0; l < levels; ++l) {
+        _level_ptr[l + 1] += _level_ptr[l];
+    }
+    _rows.resize(n);
+    std::vector<u64> fill(_level_ptr.begin(), _level_ptr.end() - 1);
+    for (u64 i = 0; i < n; ++i) {
+        _rows[fill[level[i]]++] = i;
+    }
+}
+
+u64 TriangularSolver::get_max_width() const {
+    u64 width = 0;
+    for (u64 l = 0; l < get_levels(); ++l) {
+        width = std::max(width, _level_ptr[l + 1] - _level_ptr[l]);
+    }
+    return width;
+}
+
+void TriangularSolver::solve(f64* x, u64 threads) const {
+    for (u64 l = 0; l < get_levels(); ++l) {
+        // Narrow levels fall under the grain and run inline without waking any thread.
+        parallel_for(_level_ptr[l], _level_ptr[l + 1], TRISOLVE_GRAIN, [&](u64 lo, u64 hi) {
+            for (u64 r = lo; r < hi; ++r) {
+                const u64 i = _rows[r];
+                f64 sum = x[i];
+                for (u64 k = _factor.row_ptr[i]; k < _factor.row_ptr[i + 1]; ++k) {
+                    sum -= _factor.values[k] * x[_factor.col_idx[k]];
+                }
+                x[i] = sum * _inv_diag[i];
+            }
+        }, threads);
+    }
+}
\ No newline at end of file
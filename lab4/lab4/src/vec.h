@@ -18,6 +18,14 @@ public:
     Vec(const std::initializer_list<f64>& list);
 public:
     u64 get_size() const { return _size; }
+    u64 get_nnz() const { return _data.size(); }
+
+    f64 get(u64 idx) const;
+    void set(u64 idx, f64 value);
+    void reserve(u64 nnz) { _data.reserve(nnz); }
+public:
+    template<typename F>
+    Vec map(F f) const;
 public:
     auto begin() { return _data.begin(); }
     auto end() { return _data.end(); }
@@ -36,6 +44,9 @@ public:
 
     friend Vec operator^(const Vec& vec, const f64 exp);
 
+    friend Vec mul_elem(const Vec& v1, const Vec& v2);
+    friend Vec div_elem(const Vec& v1, const Vec& v2);
+
     friend Vec operator*(const Vec& v, const Mat& m);
 private:
     std::unordered_map<u64, f64> _data;
@@ -48,7 +59,7 @@ Vec::Vec(const std::initializer_list<f64>& list)
     : _size{ list.size() } {
     u64 idx = 0;
     for (const auto& it : list) {
-        if (std::abs(it) < EPSILON) {
+        if (std::abs(it) >= EPSILON) {
             _data.emplace(idx, it);
         }
         ++idx;
@@ -58,12 +69,60 @@ Vec::Vec(const std::initializer_list<f64>& list)
 Vec::Vec(const std::vector<f64>& v)
     : _size{ v.size() } {
     for (u64 i = 0; i < v.size(); ++i) {
-        if (std::abs(v[i]) < EPSILON) {
+        if (std::abs(v[i]) >= EPSILON) {
             _data.emplace(i, v[i]);
         }
     }
 }
 
+f64 Vec::get(u64 idx) const {
+    assert((idx < _size) && "Index out of range.");
+
+    auto it = _data.find(idx);
+    return it != _data.end() ? it->second : 0.0;
+}
+
+void Vec::set(u64 idx, f64 value) {
+    assert((idx < _size) && "Index out of range.");
+
+    if (std::abs(value) >= EPSILON) {
+        _data[idx] = value;
+    }
+    else {
+        _data.erase(idx);
+    }
+}
+
+// Applies f to every element. Implicit zeros are only materialized when f(0) is not zero,
+// otherwise only the stored values are visited.
+template<typename F>
+Vec Vec::map(F f) const {
+    const f64 zero = f(0.0);
+
+    if (std::abs(zero) < EPSILON) {
+        Vec res(*this);
+
+        for (auto& [idx, value] : res._data) {
+            value = f(value);
+        }
+        std::erase_if(res._data, [](const auto& item) {
+            return std::abs(item.second) < EPSILON;
+        });
+
+        return res;
+    }
+
+    Vec res(_size);
+    res._data.reserve(_size);
+
+    for (u64 i = 0; i < _size; ++i) {
+        auto it = _data.find(i);
+        res._data.emplace(i, it != _data.end() ? f(it->second) : zero);
+    }
+
+    return res;
+}
+
 std::ostream& operator<<(std::ostream& out, const Vec& v) {
     for (u64 i = 0; i < v._size; ++i) {
         auto it = v._data.find(i);
@@ -229,12 +288,49 @@ f64 operator*(const Vec& v1, const Vec& v2) {
 }
 
 Vec operator^(const Vec& vec, const f64 exp) {
-    Vec res(vec._size);
+    return vec.map([exp](f64 value) { return std::pow(value, exp); });
+}
 
-    for (const auto& [idx, value]: vec) {
-        f64 v = std::pow(value, exp);
-        if (std::abs(v) >= EPSILON) {
-            res._data[idx] = v;
+Vec mul_elem(const Vec& v1, const Vec& v2) {
+    assert(v1._size == v2._size && "Vectrors must be the same size.");
+
+    // The product is non zero only on the intersection of both patterns,
+    // so walk the smaller one and probe the larger one.
+    const Vec& small = v1._data.size() <= v2._data.size() ? v1 : v2;
+    const Vec& large = v1._data.size() <= v2._data.size() ? v2 : v1;
+
+    Vec res(v1._size);
+    res._data.reserve(small._data.size());
+
+    for (const auto& [idx, value] : small._data) {
+        auto it = large._data.find(idx);
+        if (it == large._data.end()) {
+            continue;
+        }
+        f64 mul = value * it->second;
+        if (std::abs(mul) >= EPSILON) {
+            res._data.emplace(idx, mul);
+        }
+    }
+
+    return res;
+}
+
+Vec div_elem(const Vec& v1, const Vec& v2) {
+    assert(v1._size == v2._size && "Vectrors must be the same size.");
+
+    Vec res(v1._size);
+    res._data.reserve(v1._data.size());
+
+    for (const auto& [idx, value] : v1._data) {
+        auto it = v2._data.find(idx);
+        assert((it != v2._data.end()) && "Division by zero.");
+
+        // An implicit zero divisor gives the IEEE +-inf or NaN when asserts are off.
+        const f64 divisor = it != v2._data.end() ? it->second : 0.0;
+        f64 div = value / divisor;
+        if (std::abs(div) >= EPSILON) {
+            res._data.emplace(idx, div);
         }
     }
 
@@ -246,19 +342,17 @@ Vec operator*(const Vec& v, const Mat& m) {
 
     Vec res(m.get_cols());
 
-    for (const auto& [v_idx, v_value] : v) {
-        for (const auto& [m_idx, m_value] : m) {
-            if (v_idx == m_idx.first) {
-                res._data[m_idx.second] += v_value * m_value;
-            }
+    // One pass over the matrix probing the vector, instead of one pass per vector value.
+    for (const auto& [m_idx, m_value] : m) {
+        auto it = v._data.find(m_idx.first);
+        if (it != v._data.end()) {
+            res._data[m_idx.second] += it->second * m_value;
         }
     }
 
-    for (const auto& [idx, value] : res) {
-        if (std::abs(value) < EPSILON) {
-            res._data.erase(idx);
-        }
-    }
-    
+    std::erase_if(res._data, [](const auto& item) {
+        return std::abs(item.second) < EPSILON;
+    });
+
     return res;
 }
\ No newline at end of file